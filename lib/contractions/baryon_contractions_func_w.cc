@@ -799,44 +799,47 @@ namespace Chroma
 			 LatticeComplex & spin_color_contracted_thing)
   {
     //This does the double epsilon color contractions, there are 6 combinations per epislon, so 36 total.
-    //Antisymmetry makes half of these terms negative, positives ones below.
-    spin_color_contracted_thing  = peekColor(quark_1,0,0)*peekColor(quark_2,1,1)*peekColor(quark_3,2,2);
-    spin_color_contracted_thing += peekColor(quark_1,0,0)*peekColor(quark_2,2,2)*peekColor(quark_3,1,1);
-    spin_color_contracted_thing += peekColor(quark_1,0,1)*peekColor(quark_2,1,2)*peekColor(quark_3,2,0);
-    spin_color_contracted_thing += peekColor(quark_1,0,1)*peekColor(quark_2,2,0)*peekColor(quark_3,1,2);
-    spin_color_contracted_thing += peekColor(quark_1,0,2)*peekColor(quark_2,1,0)*peekColor(quark_3,2,1);
-    spin_color_contracted_thing += peekColor(quark_1,0,2)*peekColor(quark_2,2,1)*peekColor(quark_3,1,0);
-    spin_color_contracted_thing += peekColor(quark_1,1,0)*peekColor(quark_2,0,2)*peekColor(quark_3,2,1);
-    spin_color_contracted_thing += peekColor(quark_1,1,0)*peekColor(quark_2,2,1)*peekColor(quark_3,0,2);
-    spin_color_contracted_thing += peekColor(quark_1,1,1)*peekColor(quark_2,0,0)*peekColor(quark_3,2,2);
-    spin_color_contracted_thing += peekColor(quark_1,1,1)*peekColor(quark_2,2,2)*peekColor(quark_3,0,0);
-    spin_color_contracted_thing += peekColor(quark_1,1,2)*peekColor(quark_2,0,1)*peekColor(quark_3,2,0);
-    spin_color_contracted_thing += peekColor(quark_1,1,2)*peekColor(quark_2,2,0)*peekColor(quark_3,0,1);
-    spin_color_contracted_thing += peekColor(quark_1,2,0)*peekColor(quark_2,0,1)*peekColor(quark_3,1,2);
-    spin_color_contracted_thing += peekColor(quark_1,2,0)*peekColor(quark_2,1,2)*peekColor(quark_3,0,1);
-    spin_color_contracted_thing += peekColor(quark_1,2,1)*peekColor(quark_2,0,2)*peekColor(quark_3,1,0);
-    spin_color_contracted_thing += peekColor(quark_1,2,1)*peekColor(quark_2,1,0)*peekColor(quark_3,0,2);
-    spin_color_contracted_thing += peekColor(quark_1,2,2)*peekColor(quark_2,0,0)*peekColor(quark_3,1,1);
-    spin_color_contracted_thing += peekColor(quark_1,2,2)*peekColor(quark_2,1,1)*peekColor(quark_3,0,0);
-    //Negative terms below.
-    spin_color_contracted_thing -= peekColor(quark_1,0,0)*peekColor(quark_2,1,2)*peekColor(quark_3,2,1);
-    spin_color_contracted_thing -= peekColor(quark_1,0,0)*peekColor(quark_2,2,1)*peekColor(quark_3,1,2);
-    spin_color_contracted_thing -= peekColor(quark_1,0,1)*peekColor(quark_2,1,0)*peekColor(quark_3,2,2);
-    spin_color_contracted_thing -= peekColor(quark_1,0,1)*peekColor(quark_2,2,2)*peekColor(quark_3,1,0);
-    spin_color_contracted_thing -= peekColor(quark_1,0,2)*peekColor(quark_2,1,1)*peekColor(quark_3,2,0);
-    spin_color_contracted_thing -= peekColor(quark_1,0,2)*peekColor(quark_2,2,0)*peekColor(quark_3,1,1);
-    spin_color_contracted_thing -= peekColor(quark_1,1,0)*peekColor(quark_2,0,1)*peekColor(quark_3,2,2);
-    spin_color_contracted_thing -= peekColor(quark_1,1,0)*peekColor(quark_2,2,2)*peekColor(quark_3,0,1);
-    spin_color_contracted_thing -= peekColor(quark_1,1,1)*peekColor(quark_2,0,2)*peekColor(quark_3,2,0);
-    spin_color_contracted_thing -= peekColor(quark_1,1,1)*peekColor(quark_2,2,0)*peekColor(quark_3,0,2);
-    spin_color_contracted_thing -= peekColor(quark_1,1,2)*peekColor(quark_2,0,0)*peekColor(quark_3,2,1);
-    spin_color_contracted_thing -= peekColor(quark_1,2,0)*peekColor(quark_2,0,2)*peekColor(quark_3,1,1);
-    spin_color_contracted_thing -= peekColor(quark_1,2,0)*peekColor(quark_2,1,1)*peekColor(quark_3,0,2);
-    spin_color_contracted_thing -= peekColor(quark_1,1,2)*peekColor(quark_2,2,1)*peekColor(quark_3,0,0);
-    spin_color_contracted_thing -= peekColor(quark_1,2,1)*peekColor(quark_2,0,0)*peekColor(quark_3,1,2);
-    spin_color_contracted_thing -= peekColor(quark_1,2,1)*peekColor(quark_2,1,2)*peekColor(quark_3,0,0);
-    spin_color_contracted_thing -= peekColor(quark_1,2,2)*peekColor(quark_2,0,1)*peekColor(quark_3,1,0);
-    spin_color_contracted_thing -= peekColor(quark_1,2,2)*peekColor(quark_2,1,0)*peekColor(quark_3,0,1);
+    //colorContract evaluates eps^{i1,j1,k1} eps^{i2,j2,k2} q1^{i1,i2} q2^{j1,j2} q3^{k1,k2} site by site,
+    //so all 36 terms live in registers instead of in 108 peekColor lattice temporaries.
+    spin_color_contracted_thing = colorContract(quark_1, quark_2, quark_3);
+  }
+
+
+  namespace {
+
+      // look up the spin elementals of one (baryon, spin) pair, aborting if
+      // either is unknown
+    const SpinElemListType& get_spin_elementals(const std::string& baryon_name,
+						const std::string& spin)
+    {
+      auto bIt = elemMap.find(baryon_name);
+      if (bIt == elemMap.end()) {
+	QDPIO::cerr << "ERROR: Did not find flavor "<< baryon_name<< std::endl;
+	QDP_abort(1);
+      }
+
+      auto mIt = bIt->second.find(spin);
+      if (mIt == bIt->second.end()) {
+	QDPIO::cerr << "ERROR: Did not find spin elementals for " << baryon_name << " " <<spin<< std::endl;
+	QDP_abort(1);
+      }
+
+      return mIt->second;
+    }
+
+      // one spin slice of one quark: (flavor, sinkSpin, sourceSpin)
+    typedef std::tuple<char, uint, uint> SliceKey;
+      // the three slices entering one color contraction; colorContract is
+      // symmetric in its three arguments, so the key is kept sorted
+    typedef std::tuple<SliceKey, SliceKey, SliceKey> TripleKey;
+
+    TripleKey make_triple_key(SliceKey s1, SliceKey s2, SliceKey s3)
+    {
+      if (s2 < s1) std::swap(s1, s2);
+      if (s3 < s2) std::swap(s2, s3);
+      if (s2 < s1) std::swap(s1, s2);
+      return std::make_tuple(s1, s2, s3);
+    }
 
   }
 
@@ -849,33 +852,183 @@ namespace Chroma
 		      LatticeComplex & baryon_contracted_thing)
   {
       // get spin elemental list
-    auto bIt = elemMap.find(baryon_name);
-    if (bIt == elemMap.end()) {
-      QDPIO::cerr << "ERROR: Did not find flavor "<< baryon_name<< std::endl;
-      QDP_abort(1);
-    }
-
-    auto mIt = bIt->second.find(spin);
-    if (mIt == bIt->second.end()) {
-      QDPIO::cerr << "ERROR: Did not find spin elementals for " << baryon_name << " " <<spin<< std::endl;
-      QDP_abort(1);
-    }
+    const SpinElemListType& elems = get_spin_elementals(baryon_name, spin);
 
     //This should be passed in as zero, but I'll do it here too just to be safe.
     baryon_contracted_thing = zero;
 
-    for (auto spinEl : mIt->second) {
+    for (auto spinEl : elems) {
       std::tuple<iPair, iPair, iPair> spinComb;
       double coeff;
 
       std::tie(spinComb, coeff) = spinEl;
 
-      LatticeComplex temp_contraction = zero;
-      LatticeColorMatrix q1 = peekSpin(quark_1, std::get<0>(spinComb).first, std::get<0>(spinComb).second);
-      LatticeColorMatrix q2 = peekSpin(quark_2, std::get<1>(spinComb).first, std::get<1>(spinComb).second);
-      LatticeColorMatrix q3 = peekSpin(quark_3, std::get<2>(spinComb).first, std::get<2>(spinComb).second);
-      color_contraction(q1, q2, q3, temp_contraction);
-      baryon_contracted_thing += coeff * temp_contraction;
+      //Spin extraction, color contraction and accumulation are one expression, so this is a single
+      //sweep over the local sites with no lattice-sized intermediates.
+      baryon_contracted_thing += Real(coeff) * colorContract(
+	  peekSpin(quark_1, std::get<0>(spinComb).first, std::get<0>(spinComb).second),
+	  peekSpin(quark_2, std::get<1>(spinComb).first, std::get<1>(spinComb).second),
+	  peekSpin(quark_3, std::get<2>(spinComb).first, std::get<2>(spinComb).second));
+    }
+  }
+
+
+  namespace {
+
+      // do_contractions for either precision: P, CM and C are the
+      // propagator, color matrix and complex lattice types, R the real scalar
+    template<typename P, typename CM, typename C, typename R>
+    void do_contractions_t(const std::map<char, P> & prop_map,
+			   const std::set<std::pair<std::string, std::string>> & particle_list,
+			   std::map<std::pair<std::string, std::string>, C> & baryons,
+			   const Subset & sub)
+    {
+	// plan: every (baryon, spin) is a weighted sum of color contracted
+	// triples; collect the distinct triples over the whole list, together
+	// with the correlators (and coefficients) each one feeds into
+      std::map<TripleKey, std::vector<std::pair<std::pair<std::string, std::string>, double>>> triples;
+      std::set<SliceKey> slices;
+
+      for (auto aParticle : particle_list) {
+	auto flavCode = get_flavor_code(aParticle.first);
+	const SpinElemListType& elems = get_spin_elementals(aParticle.first, aParticle.second);
+
+	for (auto spinEl : elems) {
+	  std::tuple<iPair, iPair, iPair> spinComb;
+	  double coeff;
+
+	  std::tie(spinComb, coeff) = spinEl;
+
+	  SliceKey s1(std::get<0>(flavCode), std::get<0>(spinComb).first, std::get<0>(spinComb).second);
+	  SliceKey s2(std::get<1>(flavCode), std::get<1>(spinComb).first, std::get<1>(spinComb).second);
+	  SliceKey s3(std::get<2>(flavCode), std::get<2>(spinComb).first, std::get<2>(spinComb).second);
+	  slices.insert(s1);
+	  slices.insert(s2);
+	  slices.insert(s3);
+
+	  triples[make_triple_key(s1, s2, s3)].push_back(std::make_pair(aParticle, coeff));
+	}
+
+	baryons[aParticle] = zero;
+      }
+
+      unsigned int nTerms = 0;
+      for (auto aTriple : triples)
+	nTerms += aTriple.second.size();
+      QDPIO::cout << "Baryon contraction plan: " << particle_list.size() << " correlators, "
+		  << nTerms << " spin terms, " << triples.size() << " unique color contractions, "
+		  << slices.size() << " unique spin slices" << std::endl;
+
+	// extract each spin slice once; all slices of one propagator together
+	// are the size of that propagator
+      std::map<SliceKey, CM> slice_map;
+      for (auto aSlice : slices) {
+	auto pIt = prop_map.find(std::get<0>(aSlice));
+	if (pIt == prop_map.end()) {
+	  QDPIO::cerr << "Could not find required propagator for "<<std::get<0>(aSlice)<<" quark"<<std::endl;
+	  QDP_abort(1);
+	}
+	slice_map[aSlice][sub] = peekSpin(pIt->second, std::get<1>(aSlice), std::get<2>(aSlice));
+      }
+
+	// contract each triple once and scatter it into its correlators
+      C contracted;
+      for (auto aTriple : triples) {
+	contracted[sub] = colorContract(slice_map[std::get<0>(aTriple.first)],
+					slice_map[std::get<1>(aTriple.first)],
+					slice_map[std::get<2>(aTriple.first)]);
+
+	for (auto aTarget : aTriple.second)
+	  baryons[aTarget.first][sub] += R(aTarget.second) * contracted;
+      }
+    }
+
+  }
+
+
+  void do_contractions(const std::map<char, LatticePropagator> & prop_map,
+		       const std::set<std::pair<std::string, std::string>> & particle_list,
+		       std::map<std::pair<std::string, std::string>, LatticeComplex> & baryons,
+		       const Subset & sub)
+  {
+    do_contractions_t<LatticePropagator, LatticeColorMatrix, LatticeComplex, Real>(
+	prop_map, particle_list, baryons, sub);
+  }
+
+#if BASE_PRECISION==64
+  void do_contractions(const std::map<char, LatticePropagatorF> & prop_map,
+		       const std::set<std::pair<std::string, std::string>> & particle_list,
+		       std::map<std::pair<std::string, std::string>, LatticeComplexF> & baryons,
+		       const Subset & sub)
+  {
+    do_contractions_t<LatticePropagatorF, LatticeColorMatrixF, LatticeComplexF, RealF>(
+	prop_map, particle_list, baryons, sub);
+  }
+#endif
+
+  void write_correlator(bool antiperiodic,
+			std::string baryon_name,
+			std::string spin,
+#ifdef BUILD_HDF5
+			std::string path,
+			HDF5Writer & h5writer,
+			HDF5Base::writemode & h5mode,
+			LalibeCorrelatorBuffer * buffer,
+#endif
+			int t_0,
+			int Nt,
+			multi1d<int> & source_coords,
+			LalibeSftMom & FT,
+			const multi2d<DComplex> & FTed_baryon)
+  {
+    //Temp variable for writing below.
+    Complex temp_element;
+    //Move the h5 pushing here, since all momentum keys will be written in the same general path.
+#ifdef BUILD_HDF5
+    std::string correlator_path = path+"/"+baryon_name+"/spin_"+spin+"/x"+std::to_string(source_coords[0])+"_y"+std::to_string(source_coords[1])+"_z"+std::to_string(source_coords[2])+"_t"+std::to_string(source_coords[3]);
+    if(buffer == NULL)
+      h5writer.push(correlator_path);
+#else
+    std::string correlator_path = baryon_name+"_spin-"+spin+"_x"+std::to_string(source_coords[0])+"_y"+std::to_string(source_coords[1])+"_z"+std::to_string(source_coords[2])+"_t"+std::to_string(source_coords[3]);
+#endif
+    for(int mom = 0; mom < FT.numMom(); mom++)
+    {
+      //One more temp variable instanited inside loop (once again for writing.)
+      multi1d<Complex> baryon_correlator;
+      baryon_correlator.resize(Nt);
+      multi1d<int> momenta = FT.numToMom(mom);
+#ifndef BUILD_HDF5
+      std::string correlator_path_mom = correlator_path+"_px"+std::to_string(momenta[0])+"_py"+std::to_string(momenta[1])+"_pz"+std::to_string(momenta[2]);
+      TextFileWriter file_out(correlator_path_mom);
+#endif
+      for(int t = 0; t < Nt; t++)
+      {
+        temp_element = Complex(FTed_baryon[mom][t]); 
+        int t_relative = t - t_0;
+        if(t_relative < 0)
+          t_relative += Nt;
+        if((t_relative >= (Nt - t_0)) && antiperiodic == true)
+          temp_element = -temp_element;
+#ifndef BUILD_HDF5
+        file_out<<temp_element<<"\n";
+#endif
+        baryon_correlator[t_relative] = temp_element; 
+      }
+#ifndef BUILD_HDF5
+      file_out.close();
+#else
+      //A buffered correlator is written later with the rest of the task's correlators.
+      if(buffer != NULL)
+      {
+	buffer->add(baryon_name+"/spin_"+spin, mom, baryon_correlator);
+	continue;
+      }
+      //Change the name of string compred to 4d output so general correlator path is the same.
+      std::string correlator_path_mom = correlator_path+"/px"+std::to_string(momenta[0])+"_py"+std::to_string(momenta[1])+"_pz"+std::to_string(momenta[2]);
+      h5writer.write(correlator_path_mom, baryon_correlator, h5mode);
+      h5writer.writeAttribute(correlator_path_mom, "is_shifted", 1, h5mode);
+      h5writer.cd("/");
+#endif
     }
   }
 
@@ -907,50 +1060,12 @@ namespace Chroma
     }
     else
     {
-      //Momentum loop
-      multi2d<Complex> FTed_baryon = FT.sft(baryon);
-      //Temp variable for writing below.
-      Complex temp_element;
-      //Move the h5 pushing here, since all momentum keys will be written in the same general path.
+      //Momentum project and write through the projected version above.
+      write_correlator(antiperiodic, baryon_name, spin,
 #ifdef BUILD_HDF5
-      std::string correlator_path = path+"/"+baryon_name+"/spin_"+spin+"/x"+std::to_string(source_coords[0])+"_y"+std::to_string(source_coords[1])+"_z"+std::to_string(source_coords[2])+"_t"+std::to_string(source_coords[3]);
-      h5writer.push(correlator_path);
-#else
-      std::string correlator_path = baryon_name+"_spin-"+spin+"_x"+std::to_string(source_coords[0])+"_y"+std::to_string(source_coords[1])+"_z"+std::to_string(source_coords[2])+"_t"+std::to_string(source_coords[3]);
-#endif
-      for(int mom = 0; mom < FT.numMom(); mom++)
-      {
-	//One more temp variable instanited inside loop (once again for writing.)
-	multi1d<Complex> baryon_correlator;
-	baryon_correlator.resize(Nt);
-	multi1d<int> momenta = FT.numToMom(mom);
-#ifndef BUILD_HDF5
-	std::string correlator_path_mom = correlator_path+"_px"+std::to_string(momenta[0])+"_py"+std::to_string(momenta[1])+"_pz"+std::to_string(momenta[2]);
-	TextFileWriter file_out(correlator_path_mom);
-#endif
-	for(int t = 0; t < Nt; t++)
-	{
-	  temp_element = FTed_baryon[mom][t]; 
-	  int t_relative = t - t_0;
-	  if(t_relative < 0)
-	    t_relative += Nt;
-	  if((t_relative >= (Nt - t_0)) && antiperiodic == true)
-	    temp_element = -temp_element;
-#ifndef BUILD_HDF5
-	  file_out<<temp_element<<"\n";
+	  path, h5writer, h5mode, NULL,
 #endif
-	  baryon_correlator[t_relative] = temp_element; 
-	}
-#ifndef BUILD_HDF5
-	file_out.close();
-#else
-	//Change the name of string compred to 4d output so general correlator path is the same.
-	std::string correlator_path_mom = correlator_path+"/px"+std::to_string(momenta[0])+"_py"+std::to_string(momenta[1])+"_pz"+std::to_string(momenta[2]);
-	h5writer.write(correlator_path_mom, baryon_correlator, h5mode);
-	h5writer.writeAttribute(correlator_path_mom, "is_shifted", 1, h5mode);
-	h5writer.cd("/");
-#endif
-      }
+	  t_0, Nt, source_coords, FT, FT.sft(baryon));
     }
   }
 
@@ -8,10 +8,12 @@
 #define __baryon_contractions_func_h__
 
 #include "../momentum/lalibe_sftmom.h"
+#include "../io/correlator_buffer.h"
 
 #include <vector>
 #include <tuple>
 #include <map>
+#include <set>
 #include <utility>
 
 namespace Chroma 
@@ -35,6 +37,40 @@ namespace Chroma
 		      const std::string& spin,
 		      LatticeComplex & baryon_contracted_thing);
 
+  //Contract every (baryon, spin) pair of particle_list at once, extracting each distinct
+  //(quark, sink spin, source spin) slice and evaluating each distinct color contraction only once.
+  //Only the sites in sub (e.g. a window of time slices) are contracted, the correlators are zero elsewhere.
+  void do_contractions(const std::map<char, LatticePropagator> & prop_map,
+		       const std::set<std::pair<std::string, std::string>> & particle_list,
+		       std::map<std::pair<std::string, std::string>, LatticeComplex> & baryons,
+		       const Subset & sub = all);
+
+#if BASE_PRECISION==64
+  //Same in single precision: the slices and color contractions are all single precision,
+  //the caller projects the results with LalibeSftMom, which accumulates in double.
+  void do_contractions(const std::map<char, LatticePropagatorF> & prop_map,
+		       const std::set<std::pair<std::string, std::string>> & particle_list,
+		       std::map<std::pair<std::string, std::string>, LatticeComplexF> & baryons,
+		       const Subset & sub = all);
+#endif
+
+  //Write an already momentum projected correlator, [mom][t] as returned by LalibeSftMom::sft.
+  //With a buffer, the correlator is added to it instead and written when the buffer is.
+  void write_correlator(bool antiperiodic,
+			std::string baryon_name,
+			std::string spin,
+#ifdef BUILD_HDF5
+			std::string path,
+			HDF5Writer & h5writer,
+			HDF5Base::writemode & h5mode,
+			LalibeCorrelatorBuffer * buffer,
+#endif
+			int t_0,
+			int Nt,
+			multi1d<int> & source_coords,
+			LalibeSftMom & FT,
+			const multi2d<DComplex> & FTed_baryon);
+
   void write_correlator(bool full_correlator,
 			bool antiperiodic,
 			std::string baryon_name,
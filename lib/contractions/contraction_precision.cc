@@ -0,0 +1,51 @@
+/*! 
+ *  Precision selection for the contraction-only tasks.
+ */
+
+#include "contraction_precision.h"
+
+namespace Chroma
+{
+
+  LalibeContractionPrecision lalibePrecisionFromString(const std::string& precision)
+  {
+    LalibeContractionPrecision mode;
+    if (precision == "double")
+      mode = CONTRACT_DOUBLE;
+    else if (precision == "single")
+      mode = CONTRACT_SINGLE;
+    else if (precision == "validate")
+      mode = CONTRACT_VALIDATE;
+    else
+    {
+      QDPIO::cerr << "Unknown contraction precision " << precision << ", use double, single or validate" << std::endl;
+      QDP_abort(1);
+    }
+
+#if BASE_PRECISION==32
+    if (mode != CONTRACT_DOUBLE)
+    {
+      QDPIO::cout << "Single precision build, contracting in the build precision instead of " << precision << std::endl;
+      mode = CONTRACT_DOUBLE;
+    }
+#endif
+    return mode;
+  }
+
+
+  double maxRelativeDeviation(const multi2d<DComplex> & ref, const multi2d<DComplex> & test)
+  {
+    double max_dev = 0.0;
+    for (int mom = 0; mom < ref.size2(); ++mom)
+      for (int t = 0; t < ref.size1(); ++t)
+      {
+	double diff = toDouble(sqrt(norm2(test[mom][t] - ref[mom][t])));
+	double size = toDouble(sqrt(norm2(ref[mom][t])));
+	double dev = (size > 0.0) ? diff / size : diff;
+	if (dev > max_dev)
+	  max_dev = dev;
+      }
+    return max_dev;
+  }
+
+}
@@ -0,0 +1,29 @@
+/*! 
+ *  Precision selection for the contraction-only tasks.
+ *  "double" contracts in the build precision, "single" holds and contracts the propagators in single
+ *  precision (the momentum projection still sums in double) and "validate" does both and reports how far
+ *  the single precision correlators are from the double ones.
+ */
+
+#ifndef __contraction_precision_h__
+#define __contraction_precision_h__
+
+#include "chromabase.h"
+
+#include <string>
+
+namespace Chroma
+{
+
+  enum LalibeContractionPrecision { CONTRACT_DOUBLE, CONTRACT_SINGLE, CONTRACT_VALIDATE };
+
+  //Map the XML precision string ("double", "single" or "validate") onto a LalibeContractionPrecision.
+  //In a single precision build there is nothing to gain, everything falls back to CONTRACT_DOUBLE.
+  LalibeContractionPrecision lalibePrecisionFromString(const std::string& precision);
+
+  //Largest |test - ref| / |ref| over all momenta and time slices, |test - ref| where ref vanishes.
+  double maxRelativeDeviation(const multi2d<DComplex> & ref, const multi2d<DComplex> & test);
+
+}
+
+#endif
@@ -20,6 +20,172 @@
 namespace Chroma
 {
 
+  namespace {
+
+    //One term of a meson two-point function: quark, antiquark, sink and source gamma (Chroma Gamma(n) index,
+    //g1=1, g2=2, g3=4, g4=8, g5=15) and its weight. The contraction is trace(Gamma_snk q Gamma_src g5 adj(qbar) g5),
+    //so with Gbar = g4 adj(Gamma) g4 and the fermion loop sign an interpolator Gamma enters as (Gamma, Gbar, -1):
+    //pseudoscalars (g5, g5, +1), scalars (1, 1, -1), vectors (gi, gi, +1).
+    struct MesonTerm
+    {
+      char quark;
+      char antiquark;
+      int gamma_snk;
+      int gamma_src;
+      double coeff;
+    };
+
+    typedef std::vector<MesonTerm> MesonTermListType;
+
+    std::map<std::string, MesonTermListType> mesonMap = {
+      { "piplus",   { { 'u', 'd', 15, 15, 1.0 } } },
+      { "piminus",  { { 'd', 'u', 15, 15, 1.0 } } },
+      //connected part of the pi0 only, (uubar - ddbar)/sqrt(2)
+      { "pi0_conn", { { 'u', 'u', 15, 15, 0.5 }, { 'd', 'd', 15, 15, 0.5 } } },
+      { "kplus",    { { 'u', 's', 15, 15, 1.0 } } },
+      { "kminus",   { { 's', 'u', 15, 15, 1.0 } } },
+      { "kzero",    { { 'd', 's', 15, 15, 1.0 } } },
+      { "kzerobar", { { 's', 'd', 15, 15, 1.0 } } },
+      { "a0plus",   { { 'u', 'd', 0, 0, -1.0 } } },
+      { "a0minus",  { { 'd', 'u', 0, 0, -1.0 } } },
+      { "rhoplus_x",  { { 'u', 'd', 1, 1, 1.0 } } },
+      { "rhoplus_y",  { { 'u', 'd', 2, 2, 1.0 } } },
+      { "rhoplus_z",  { { 'u', 'd', 4, 4, 1.0 } } },
+      { "rhominus_x", { { 'd', 'u', 1, 1, 1.0 } } },
+      { "rhominus_y", { { 'd', 'u', 2, 2, 1.0 } } },
+      { "rhominus_z", { { 'd', 'u', 4, 4, 1.0 } } },
+    };
+
+    const MesonTermListType & get_meson_terms(const std::string& meson_name)
+    {
+      auto mIt = mesonMap.find(meson_name);
+      if (mIt == mesonMap.end()) {
+	QDPIO::cerr << "Did not find a meson definition for " << meson_name << std::endl;
+	QDP_abort(1);
+      }
+      return mIt->second;
+    }
+
+  }
+
+  std::set<char> get_meson_flavors(const std::string& meson_name)
+  {
+    std::set<char> flavors;
+    for (const auto & aTerm : get_meson_terms(meson_name)) {
+      flavors.insert(aTerm.quark);
+      flavors.insert(aTerm.antiquark);
+    }
+    return flavors;
+  }
+
+
+  void do_meson_contractions(const std::map<char, LatticePropagator> & prop_map,
+			     const std::vector<std::string> & particle_list,
+			     bool dirac_basis,
+			     std::vector<std::string> & meson_names,
+			     std::map<std::string, LatticeComplex> & mesons,
+			     const Subset & sub)
+  {
+    //Every meson is a weighted sum of (Gamma_snk, Gamma_src) channels of some quark-antiquark pairs.
+    //Collect the distinct channels per pair, run the fused kernel once per pair and assemble the mesons after.
+    typedef std::pair<char, char> FlavPair;
+    typedef std::pair<int, int> GammaPair;
+    std::map<FlavPair, std::map<GammaPair, int>> channel_map;
+    //output name -> (pair, channel, weight) list
+    std::map<std::string, std::vector<std::tuple<FlavPair, GammaPair, double>>> recipes;
+
+    auto add_term = [&](const std::string& out_name, const FlavPair& flav, const GammaPair& gam, double coeff) {
+      auto & channels = channel_map[flav];
+      if (channels.find(gam) == channels.end()) {
+	int next = channels.size();
+	channels[gam] = next;
+      }
+      if (recipes.find(out_name) == recipes.end())
+	meson_names.push_back(out_name);
+      recipes[out_name].push_back(std::make_tuple(flav, gam, coeff));
+    };
+
+    //A meson listed twice would get its recipe twice and come out doubled, so each is only added once.
+    std::set<std::string> seen;
+    for (const auto & aMeson : particle_list) {
+      if (!seen.insert(aMeson).second) {
+	QDPIO::cout << aMeson << " is listed more than once in particle_list, computing it once." << std::endl;
+	continue;
+      }
+      const auto & terms = get_meson_terms(aMeson);
+      for (const auto & aTerm : terms)
+	add_term(aMeson, FlavPair(aTerm.quark, aTerm.antiquark), GammaPair(aTerm.gamma_snk, aTerm.gamma_src), aTerm.coeff);
+    }
+
+    multi1d<SpinMatrix> gamma(Ns*Ns);
+    for (int g = 0; g < Ns*Ns; g++)
+      gamma[g] = gamma_matrix(g, dirac_basis);
+
+    int n_channels = 0;
+    for (const auto & aOut : meson_names)
+      mesons[aOut] = zero;
+
+    for (const auto & aPair : channel_map) {
+      auto q1It = prop_map.find(aPair.first.first);
+      auto q2It = prop_map.find(aPair.first.second);
+      if (q1It == prop_map.end() || q2It == prop_map.end()) {
+	QDPIO::cerr << "Missing propagator for the " << aPair.first.first << aPair.first.second << " meson contractions" << std::endl;
+	QDP_abort(1);
+      }
+
+      std::vector<std::pair<SpinMatrix, SpinMatrix>> gammas(aPair.second.size());
+      for (const auto & aChannel : aPair.second)
+	gammas[aChannel.second] = std::make_pair(gamma[aChannel.first.first], gamma[aChannel.first.second]);
+
+      multi1d<LatticeComplex> contracted;
+      meson_contractions(q1It->second, q2It->second, gammas, gamma[Ns*Ns-1], contracted, sub);
+      n_channels += gammas.size();
+
+      for (const auto & aRecipe : recipes)
+	for (const auto & aTerm : aRecipe.second)
+	  if (std::get<0>(aTerm) == aPair.first)
+	    mesons[aRecipe.first][sub] += Real(std::get<2>(aTerm)) * contracted[aPair.second.at(std::get<1>(aTerm))];
+    }
+
+    QDPIO::cout << "Meson contractions: " << meson_names.size() << " correlators from " << n_channels
+		<< " gamma channels of " << channel_map.size() << " quark-antiquark pairs" << std::endl;
+  }
+
+
+  bool meson_gamma_channels(const std::map<char, LatticePropagator> & prop_map,
+			    const std::string & meson_name,
+			    int gamma_snk,
+			    bool dirac_basis,
+			    std::vector<std::string> & channel_names,
+			    multi1d<LatticeComplex> & channels,
+			    const Subset & sub)
+  {
+    const auto & terms = get_meson_terms(meson_name);
+    if (terms.size() != 1) {
+      QDPIO::cout << meson_name << " is not a single quark-antiquark pair, not writing its gamma channels." << std::endl;
+      return false;
+    }
+
+    auto q1It = prop_map.find(terms[0].quark);
+    auto q2It = prop_map.find(terms[0].antiquark);
+    if (q1It == prop_map.end() || q2It == prop_map.end()) {
+      QDPIO::cerr << "Missing propagator for the " << meson_name << " gamma channels" << std::endl;
+      QDP_abort(1);
+    }
+
+    SpinMatrix g_snk = gamma_matrix(gamma_snk, dirac_basis);
+    std::vector<std::pair<SpinMatrix, SpinMatrix>> gammas(Ns*Ns);
+    channel_names.resize(Ns*Ns);
+    for (int src = 0; src < Ns*Ns; src++) {
+      gammas[src] = std::make_pair(g_snk, gamma_matrix(src, dirac_basis));
+      channel_names[src] = meson_name + "_g" + std::to_string(gamma_snk) + "_g" + std::to_string(src);
+    }
+
+    meson_contractions(q1It->second, q2It->second, gammas, gamma_matrix(Ns*Ns-1, dirac_basis), channels, sub);
+    return true;
+  }
+
+
   void anti_quark_FH_prop(LatticePropagator & FH_quark_prop,
                           LatticePropagator & FH_antiquark_prop,
                           std::string& cur)
@@ -106,6 +272,15 @@ namespace Chroma
   }
 
 
+  int anti_quark_FH_sign(const std::string& cur)
+  {
+    //The sign anti_quark_FH_prop puts in front of adj(g5 prop g5) for each current.
+    if(cur == "V1" || cur == "V2" || cur == "V3" || cur == "V4" || cur == "CHROMO_MAG")
+      return -1;
+    return 1;
+  }
+
+
   void FH_I_one_Iz_pm_one_contract(LatticePropagator & quark_1,
                              LatticePropagator & quark_2,
                              LatticeComplex & contracted,
@@ -113,22 +288,13 @@ namespace Chroma
                              std::string& cur)
   {
     //quark_1 is the forward (possibly FH) prop, quark_2 is the antiquark.
+    //trace(g5 q1 g5 * adj(g5 q2 g5)) = trace(q1 adj(q2)), which localInnerProduct does per site
+    //without building the anti-quark propagator.
 
-       int which_gamma_five = Ns*Ns-1;
+       I_one_Iz_pm_one_contract(quark_1, quark_2, contracted);
 
-	   if(is_FH_antiquark == false)
-       {
-        LatticePropagator anti_quark_prop = adj(Gamma(which_gamma_five)*quark_2*Gamma(which_gamma_five));
-        contracted = trace(Gamma(which_gamma_five)*quark_1*Gamma(which_gamma_five)*anti_quark_prop);
-       }
-       else if (is_FH_antiquark == true)
-       {
-        LatticePropagator anti_quark_prop;
-
-        anti_quark_FH_prop(quark_2,anti_quark_prop,cur);
-
-        contracted = trace(Gamma(which_gamma_five)*quark_1*Gamma(which_gamma_five)*anti_quark_prop);
-       }
+       if(is_FH_antiquark == true && anti_quark_FH_sign(cur) < 0)
+        contracted = -contracted;
 
   }
 
@@ -138,16 +304,228 @@ namespace Chroma
                              LatticeComplex & contracted)
   {
     //quark_1 is the forward prop, quark_2 is the antiquark.
+    //trace(g5 q1 g5 * adj(g5 q2 g5)) = trace(q1 adj(q2)) = sum over all spin-color elements of conj(q2) q1.
+
+        contracted = localInnerProduct(quark_2, quark_1);
+
+  }
+
+
+  SpinPerm spin_perm(const SpinMatrix & gamma)
+  {
+    SpinPerm perm;
+    for(int row = 0; row < Ns; row++)
+    {
+      perm.col[row] = -1;
+      for(int col = 0; col < Ns; col++)
+      {
+        Complex element = peekSpin(gamma, row, col);
+        std::complex<double> value(toDouble(real(element)), toDouble(imag(element)));
+        if(std::abs(value) < 1e-6)
+          continue;
+        if(perm.col[row] >= 0)
+        {
+          QDPIO::cerr << "spin_perm: spin matrix has more than one non-zero per row, not a gamma structure" << std::endl;
+          QDP_abort(1);
+        }
+        perm.col[row] = col;
+        perm.val[row] = value;
+      }
+      if(perm.col[row] < 0)
+      {
+        QDPIO::cerr << "spin_perm: spin matrix has an empty row, not a gamma structure" << std::endl;
+        QDP_abort(1);
+      }
+    }
+    return perm;
+  }
+
 
-       int which_gamma_five = Ns*Ns-1;
+  SpinMatrix gamma_matrix(int gamma_index, bool dirac_basis)
+  {
+    SpinMatrix g_one = 1.0;
+    SpinMatrix gamma = Gamma(gamma_index) * g_one;
+    if(dirac_basis)
+    {
+      //Same rotation as rotate_to_Dirac_Basis applies to the propagators.
+      SpinMatrix U = DiracToDRMat();
+      gamma = adj(U) * gamma * U;
+    }
+    return gamma;
+  }
+
+
+  void meson_contractions(const LatticePropagator & quark_1,
+                          const LatticePropagator & quark_2,
+                          const std::vector<std::pair<SpinMatrix, SpinMatrix>> & gammas,
+                          const SpinMatrix & g_five,
+                          multi1d<LatticeComplex> & contracted,
+                          const Subset & sub)
+  {
+    //quark_1 is the forward prop, quark_2 is the antiquark. For every (Gamma_snk, Gamma_src) pair
+    //  C = trace(Gamma_snk q1 Gamma_src g5 adj(q2) g5).
+    //Every gamma matrix has a single non-zero per row, so with a = Gamma_snk, b = Gamma_src, N = g5 adj(q2) g5
+    //  C = sum_{i,k} a[i] b[k] tr_c( q1_{col_a(i),k} N_{col_b(k),i} )
+    //i.e. 16 color traces per channel. The color traces needed by all channels are formed once per site
+    //straight from q1 and q2, so nothing lattice sized is allocated besides the results.
+    const int n_ch = gammas.size();
+    std::vector<SpinPerm> snk(n_ch), src(n_ch);
+    for(int ch = 0; ch < n_ch; ch++)
+    {
+      snk[ch] = spin_perm(gammas[ch].first);
+      src[ch] = spin_perm(gammas[ch].second);
+    }
+
+    SpinPerm five = spin_perm(g_five);
+    int five_inv[Ns];
+    for(int l = 0; l < Ns; l++)
+      five_inv[five.col[l]] = l;
+
+    //Collect the distinct color traces T[j][k][l][i] = tr_c(q1_{jk} N_{li}) used by any channel.
+    std::vector<int> trace_id(Ns*Ns*Ns*Ns, -1);
+    std::vector<std::array<int,4>> trace_list;
+    std::vector<std::vector<std::pair<int, std::complex<double>>>> channel_terms(n_ch);
+    for(int ch = 0; ch < n_ch; ch++)
+      for(int i = 0; i < Ns; i++)
+        for(int k = 0; k < Ns; k++)
+        {
+          int j = snk[ch].col[i];
+          int l = src[ch].col[k];
+          int idx = ((j*Ns + k)*Ns + l)*Ns + i;
+          if(trace_id[idx] < 0)
+          {
+            trace_id[idx] = trace_list.size();
+            trace_list.push_back({{j, k, l, i}});
+          }
+          channel_terms[ch].push_back(std::make_pair(trace_id[idx], snk[ch].val[i] * src[ch].val[k]));
+        }
+
+    //N_{li}^{ba} = g5[l] g5[r] conj(q2_{r,col5(l)}^{ab}) with r = col5^{-1}(i), fold the g5 values in up front.
+    std::vector<std::complex<double>> trace_coeff(trace_list.size());
+    std::vector<int> q2_row(trace_list.size()), q2_col(trace_list.size());
+    for(unsigned int n = 0; n < trace_list.size(); n++)
+    {
+      int l = trace_list[n][2];
+      int i = trace_list[n][3];
+      q2_row[n] = five_inv[i];
+      q2_col[n] = five.col[l];
+      trace_coeff[n] = five.val[l] * five.val[five_inv[i]];
+    }
+
+    contracted.resize(n_ch);
+    const int n_sites = sub.numSiteTable();
+    if(n_sites != Layout::sitesOnNode())
+      for(int ch = 0; ch < n_ch; ch++)
+        contracted[ch] = zero;
+
+    const int* site_table = sub.siteTable().slice();
+    const int n_traces = trace_list.size();
 
+    //Sites are independent, the threads only share the read only tables.
+#pragma omp parallel
+    {
+      std::vector<std::complex<double>> T(n_traces);
+
+#pragma omp for
+      for(int j_site = 0; j_site < n_sites; j_site++)
+      {
+        const int site = site_table[j_site];
+        const auto & p1 = quark_1.elem(site);
+        const auto & p2 = quark_2.elem(site);
 
-        LatticePropagator anti_quark_prop = adj(Gamma(which_gamma_five)*quark_2*Gamma(which_gamma_five));
-        contracted = trace(Gamma(which_gamma_five)*quark_1*Gamma(which_gamma_five)*anti_quark_prop);
+        for(int n = 0; n < n_traces; n++)
+        {
+          const auto & m1 = p1.elem(trace_list[n][0], trace_list[n][1]);
+          const auto & m2 = p2.elem(q2_row[n], q2_col[n]);
+          double re = 0.0, im = 0.0;
+          for(int a = 0; a < Nc; a++)
+            for(int b = 0; b < Nc; b++)
+            {
+              //q1^{ab} * conj(q2^{ab})
+              double r1 = m1.elem(a,b).real(), i1 = m1.elem(a,b).imag();
+              double r2 = m2.elem(a,b).real(), i2 = m2.elem(a,b).imag();
+              re += r1*r2 + i1*i2;
+              im += i1*r2 - r1*i2;
+            }
+          T[n] = trace_coeff[n] * std::complex<double>(re, im);
+        }
 
+        for(int ch = 0; ch < n_ch; ch++)
+        {
+          std::complex<double> value(0.0, 0.0);
+          for(const auto & term : channel_terms[ch])
+            value += term.second * T[term.first];
+          contracted[ch].elem(site).elem().elem().real() = value.real();
+          contracted[ch].elem(site).elem().elem().imag() = value.imag();
+        }
+      }
+    }
   }
 
 
+  void write_correlator(std::string meson_name,
+#ifdef BUILD_HDF5
+			std::string path,
+			HDF5Writer & h5writer,
+			HDF5Base::writemode & h5mode,
+			LalibeCorrelatorBuffer * buffer,
+#endif
+			int t_0,
+			int Nt,
+			multi1d<int> & source_coords,
+			LalibeSftMom & FT,
+			const multi2d<DComplex> & FTed_meson)
+  {
+    //Temp variable for writing below.
+    Complex temp_element;
+    //Move the h5 pushing here, since all momentum keys will be written in the same general path.
+#ifdef BUILD_HDF5
+    std::string correlator_path = path+"/"+meson_name+"/x"+std::to_string(source_coords[0])+"_y"+std::to_string(source_coords[1])+"_z"+std::to_string(source_coords[2])+"_t"+std::to_string(source_coords[3]);
+    if(buffer == NULL)
+      h5writer.push(correlator_path);
+#else
+    std::string correlator_path = meson_name+"_x"+std::to_string(source_coords[0])+"_y"+std::to_string(source_coords[1])+"_z"+std::to_string(source_coords[2])+"_t"+std::to_string(source_coords[3]);
+#endif
+    for(int mom = 0; mom < FT.numMom(); mom++)
+    {
+      //One more temp variable instanited inside loop (once again for writing.)
+      multi1d<Complex> meson_correlator;
+      meson_correlator.resize(Nt);
+      multi1d<int> momenta = FT.numToMom(mom);
+#ifndef BUILD_HDF5
+      std::string correlator_path_mom = correlator_path+"_px"+std::to_string(momenta[0])+"_py"+std::to_string(momenta[1])+"_pz"+std::to_string(momenta[2]);
+      TextFileWriter file_out(correlator_path_mom);
+#endif
+      for(int t = 0; t < Nt; t++)
+      {
+        temp_element = Complex(FTed_meson[mom][t]);
+        int t_relative = t - t_0;
+        if(t_relative < 0)
+          t_relative += Nt;
+
+#ifndef BUILD_HDF5
+        file_out<<temp_element<<"\n";
+#endif
+        meson_correlator[t_relative] = temp_element;
+      }
+#ifndef BUILD_HDF5
+      file_out.close();
+#else
+      //A buffered correlator is written later with the rest of the task's correlators.
+      if(buffer != NULL)
+      {
+	buffer->add(meson_name, mom, meson_correlator);
+	continue;
+      }
+      //Change the name of string compred to 4d output so general correlator path is the same.
+      std::string correlator_path_mom = correlator_path+"/px"+std::to_string(momenta[0])+"_py"+std::to_string(momenta[1])+"_pz"+std::to_string(momenta[2]);
+      h5writer.write(correlator_path_mom, meson_correlator, h5mode);
+      h5writer.writeAttribute(correlator_path_mom, "is_shifted", 1, h5mode);
+      h5writer.cd("/");
+#endif
+    }
+  }
+
   void write_correlator(bool full_correlator,
 			std::string meson_name,
 #ifdef BUILD_HDF5
@@ -174,49 +552,12 @@ namespace Chroma
     }
     else
     {
-      //Momentum loop
-      multi2d<Complex> FTed_meson = FT.sft(meson);
-      //Temp variable for writing below.
-      Complex temp_element;
-      //Move the h5 pushing here, since all momentum keys will be written in the same general path.
+      //Momentum project and write through the projected version above.
+      write_correlator(meson_name,
 #ifdef BUILD_HDF5
-      std::string correlator_path = path+"/"+meson_name+"/x"+std::to_string(source_coords[0])+"_y"+std::to_string(source_coords[1])+"_z"+std::to_string(source_coords[2])+"_t"+std::to_string(source_coords[3]);
-      h5writer.push(correlator_path);
-#else
-      std::string correlator_path = meson_name+"_x"+std::to_string(source_coords[0])+"_y"+std::to_string(source_coords[1])+"_z"+std::to_string(source_coords[2])+"_t"+std::to_string(source_coords[3]);
-#endif
-      for(int mom = 0; mom < FT.numMom(); mom++)
-      {
-	//One more temp variable instanited inside loop (once again for writing.)
-	multi1d<Complex> meson_correlator;
-	meson_correlator.resize(Nt);
-	multi1d<int> momenta = FT.numToMom(mom);
-#ifndef BUILD_HDF5
-	std::string correlator_path_mom = correlator_path+"_px"+std::to_string(momenta[0])+"_py"+std::to_string(momenta[1])+"_pz"+std::to_string(momenta[2]);
-	TextFileWriter file_out(correlator_path_mom);
-#endif
-	for(int t = 0; t < Nt; t++)
-	{
-	  temp_element = FTed_meson[mom][t];
-	  int t_relative = t - t_0;
-	  if(t_relative < 0)
-	    t_relative += Nt;
-
-#ifndef BUILD_HDF5
-	  file_out<<temp_element<<"\n";
+	  path, h5writer, h5mode, NULL,
 #endif
-	  meson_correlator[t_relative] = temp_element;
-	}
-#ifndef BUILD_HDF5
-	file_out.close();
-#else
-	//Change the name of string compred to 4d output so general correlator path is the same.
-	std::string correlator_path_mom = correlator_path+"/px"+std::to_string(momenta[0])+"_py"+std::to_string(momenta[1])+"_pz"+std::to_string(momenta[2]);
-	h5writer.write(correlator_path_mom, meson_correlator, h5mode);
-	h5writer.writeAttribute(correlator_path_mom, "is_shifted", 1, h5mode);
-	h5writer.cd("/");
-#endif
-      }
+	  t_0, Nt, source_coords, FT, FT.sft(meson));
     }
   }
 
@@ -9,10 +9,35 @@
 #define __meson_contractions_func_h__
 
 #include "../momentum/lalibe_sftmom.h"
+#include "../io/correlator_buffer.h"
+
+#include <array>
+#include <complex>
+#include <map>
+#include <set>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 namespace Chroma
 {
 
+  //A gamma structure as a phase permutation: row i has its single non-zero, val[i], in column col[i].
+  struct SpinPerm
+  {
+    int col[Ns];
+    std::complex<double> val[Ns];
+  };
+
+  //Abort if the spin matrix is not a phase permutation (true for all 16 gamma structures in any basis used here).
+  SpinPerm spin_perm(const SpinMatrix & gamma);
+
+  //Gamma(gamma_index) as a spin matrix, optionally rotated like rotate_to_Dirac_Basis rotates the propagators.
+  SpinMatrix gamma_matrix(int gamma_index, bool dirac_basis);
+
+  //Sign that anti_quark_FH_prop applies for the current cur.
+  int anti_quark_FH_sign(const std::string& cur);
+
   void anti_quark_FH_prop(LatticePropagator & FH_quark_prop,
                           LatticePropagator & FH_antiquark_prop,
                           std::string& cur);
@@ -32,6 +57,52 @@ namespace Chroma
                              LatticePropagator & quark_2,
                              LatticeComplex & contracted);
 
+  //contracted[ch] = trace(gammas[ch].first * quark_1 * gammas[ch].second * g_five * adj(quark_2) * g_five)
+  //for all channels at once, in a single site local pass over the sites of sub (zero elsewhere).
+  void meson_contractions(const LatticePropagator & quark_1,
+                          const LatticePropagator & quark_2,
+                          const std::vector<std::pair<SpinMatrix, SpinMatrix>> & gammas,
+                          const SpinMatrix & g_five,
+                          multi1d<LatticeComplex> & contracted,
+                          const Subset & sub = all);
+
+  //Quark flavors that the meson table needs for meson_name, aborts for unknown mesons.
+  std::set<char> get_meson_flavors(const std::string& meson_name);
+
+  //Evaluate all mesons in particle_list from the meson table with one meson_contractions pass per quark-antiquark
+  //pair. meson_names gets the output names in order. Only the sites in sub are contracted.
+  void do_meson_contractions(const std::map<char, LatticePropagator> & prop_map,
+			     const std::vector<std::string> & particle_list,
+			     bool dirac_basis,
+			     std::vector<std::string> & meson_names,
+			     std::map<std::string, LatticeComplex> & mesons,
+			     const Subset & sub = all);
+
+  //The Ns*Ns gamma channels <name>_g<gamma_snk>_g<src> of the single-pair meson meson_name, one sink gamma per
+  //call so that only Ns*Ns channels are held at a time. Returns false, with nothing computed, for other mesons.
+  bool meson_gamma_channels(const std::map<char, LatticePropagator> & prop_map,
+			    const std::string & meson_name,
+			    int gamma_snk,
+			    bool dirac_basis,
+			    std::vector<std::string> & channel_names,
+			    multi1d<LatticeComplex> & channels,
+			    const Subset & sub = all);
+
+  //Write an already momentum projected correlator, [mom][t] as returned by LalibeSftMom::sft.
+  //With a buffer, the correlator is added to it instead and written when the buffer is.
+  void write_correlator(std::string meson_name,
+#ifdef BUILD_HDF5
+			std::string path,
+			HDF5Writer & h5writer,
+			HDF5Base::writemode & h5mode,
+			LalibeCorrelatorBuffer * buffer,
+#endif
+			int t_0,
+			int Nt,
+			multi1d<int> & source_coords,
+			LalibeSftMom & FT,
+			const multi2d<DComplex> & FTed_meson);
+
   void write_correlator(bool full_correlator,
 			std::string meson_name,
 #ifdef BUILD_HDF5
@@ -110,44 +110,8 @@ namespace LegacyProton {
     )
     {
         //This does the double epsilon color contractions, there are 6 combinations per epislon, so 36 total.
-        //Antisymmetry makes half of these terms negative, positives ones below.
-        spin_color_contracted_thing  = peekColor(quark_1,0,0)*peekColor(quark_2,1,1)*peekColor(quark_3,2,2);
-        spin_color_contracted_thing += peekColor(quark_1,0,0)*peekColor(quark_2,2,2)*peekColor(quark_3,1,1);
-        spin_color_contracted_thing += peekColor(quark_1,0,1)*peekColor(quark_2,1,2)*peekColor(quark_3,2,0);
-        spin_color_contracted_thing += peekColor(quark_1,0,1)*peekColor(quark_2,2,0)*peekColor(quark_3,1,2);
-        spin_color_contracted_thing += peekColor(quark_1,0,2)*peekColor(quark_2,1,0)*peekColor(quark_3,2,1);
-        spin_color_contracted_thing += peekColor(quark_1,0,2)*peekColor(quark_2,2,1)*peekColor(quark_3,1,0);
-        spin_color_contracted_thing += peekColor(quark_1,1,0)*peekColor(quark_2,0,2)*peekColor(quark_3,2,1);
-        spin_color_contracted_thing += peekColor(quark_1,1,0)*peekColor(quark_2,2,1)*peekColor(quark_3,0,2);
-        spin_color_contracted_thing += peekColor(quark_1,1,1)*peekColor(quark_2,0,0)*peekColor(quark_3,2,2);
-        spin_color_contracted_thing += peekColor(quark_1,1,1)*peekColor(quark_2,2,2)*peekColor(quark_3,0,0);
-        spin_color_contracted_thing += peekColor(quark_1,1,2)*peekColor(quark_2,0,1)*peekColor(quark_3,2,0);
-        spin_color_contracted_thing += peekColor(quark_1,1,2)*peekColor(quark_2,2,0)*peekColor(quark_3,0,1);
-        spin_color_contracted_thing += peekColor(quark_1,2,0)*peekColor(quark_2,0,1)*peekColor(quark_3,1,2);
-        spin_color_contracted_thing += peekColor(quark_1,2,0)*peekColor(quark_2,1,2)*peekColor(quark_3,0,1);
-        spin_color_contracted_thing += peekColor(quark_1,2,1)*peekColor(quark_2,0,2)*peekColor(quark_3,1,0);
-        spin_color_contracted_thing += peekColor(quark_1,2,1)*peekColor(quark_2,1,0)*peekColor(quark_3,0,2);
-        spin_color_contracted_thing += peekColor(quark_1,2,2)*peekColor(quark_2,0,0)*peekColor(quark_3,1,1);
-        spin_color_contracted_thing += peekColor(quark_1,2,2)*peekColor(quark_2,1,1)*peekColor(quark_3,0,0);
-        //Negative terms below.
-        spin_color_contracted_thing -= peekColor(quark_1,0,0)*peekColor(quark_2,1,2)*peekColor(quark_3,2,1);
-        spin_color_contracted_thing -= peekColor(quark_1,0,0)*peekColor(quark_2,2,1)*peekColor(quark_3,1,2);
-        spin_color_contracted_thing -= peekColor(quark_1,0,1)*peekColor(quark_2,1,0)*peekColor(quark_3,2,2);
-        spin_color_contracted_thing -= peekColor(quark_1,0,1)*peekColor(quark_2,2,2)*peekColor(quark_3,1,0);
-        spin_color_contracted_thing -= peekColor(quark_1,0,2)*peekColor(quark_2,1,1)*peekColor(quark_3,2,0);
-        spin_color_contracted_thing -= peekColor(quark_1,0,2)*peekColor(quark_2,2,0)*peekColor(quark_3,1,1);
-        spin_color_contracted_thing -= peekColor(quark_1,1,0)*peekColor(quark_2,0,1)*peekColor(quark_3,2,2);
-        spin_color_contracted_thing -= peekColor(quark_1,1,0)*peekColor(quark_2,2,2)*peekColor(quark_3,0,1);
-        spin_color_contracted_thing -= peekColor(quark_1,1,1)*peekColor(quark_2,0,2)*peekColor(quark_3,2,0);
-        spin_color_contracted_thing -= peekColor(quark_1,1,1)*peekColor(quark_2,2,0)*peekColor(quark_3,0,2);
-        spin_color_contracted_thing -= peekColor(quark_1,1,2)*peekColor(quark_2,0,0)*peekColor(quark_3,2,1);
-        spin_color_contracted_thing -= peekColor(quark_1,2,0)*peekColor(quark_2,0,2)*peekColor(quark_3,1,1);
-        spin_color_contracted_thing -= peekColor(quark_1,2,0)*peekColor(quark_2,1,1)*peekColor(quark_3,0,2);
-        spin_color_contracted_thing -= peekColor(quark_1,1,2)*peekColor(quark_2,2,1)*peekColor(quark_3,0,0);
-        spin_color_contracted_thing -= peekColor(quark_1,2,1)*peekColor(quark_2,0,0)*peekColor(quark_3,1,2);
-        spin_color_contracted_thing -= peekColor(quark_1,2,1)*peekColor(quark_2,1,2)*peekColor(quark_3,0,0);
-        spin_color_contracted_thing -= peekColor(quark_1,2,2)*peekColor(quark_2,0,1)*peekColor(quark_3,1,0);
-        spin_color_contracted_thing -= peekColor(quark_1,2,2)*peekColor(quark_2,1,0)*peekColor(quark_3,0,1);
+        //colorContract does all of them site by site in one pass.
+        spin_color_contracted_thing = colorContract(quark_1, quark_2, quark_3);
     }
 
     void spin_contraction(
@@ -167,12 +131,11 @@ namespace LegacyProton {
         {
             for(int snk_index = 0; snk_index < snk_weights.size(); snk_index++)
             {
-                LatticeComplex temp_contraction = zero;
-                LatticeColorMatrix q1 = peekSpin(quark_1, snk_spins[snk_index][0], src_spins[src_index][0]);
-                LatticeColorMatrix q2 = peekSpin(quark_2, snk_spins[snk_index][1], src_spins[src_index][1]);
-                LatticeColorMatrix q3 = peekSpin(quark_3, snk_spins[snk_index][2], src_spins[src_index][2]);
-                color_contraction(q1, q2, q3, temp_contraction);
-                baryon_contracted_thing += src_weights[src_index] * snk_weights[snk_index] * temp_contraction;
+                Real weight = src_weights[src_index] * snk_weights[snk_index];
+                baryon_contracted_thing += weight * colorContract(
+                    peekSpin(quark_1, snk_spins[snk_index][0], src_spins[src_index][0]),
+                    peekSpin(quark_2, snk_spins[snk_index][1], src_spins[src_index][1]),
+                    peekSpin(quark_3, snk_spins[snk_index][2], src_spins[src_index][2]));
             }
         }
     }
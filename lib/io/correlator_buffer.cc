@@ -0,0 +1,75 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Momentum projected correlators of a task, held in memory and written as one dataset
+ */
+
+//Protect everything with a preprocessing directive.
+#ifdef BUILD_HDF5
+
+#include "correlator_buffer.h"
+
+namespace Chroma
+{
+  LalibeCorrelatorBuffer::LalibeCorrelatorBuffer(LalibeSftMom& FT, int Nt_) : num_mom(FT.numMom()), Nt(Nt_)
+  {
+    momenta.resize(num_mom*3);
+    for(int mom = 0; mom < num_mom; mom++)
+    {
+      multi1d<int> p = FT.numToMom(mom);
+      for(int i = 0; i < 3; i++)
+	momenta[mom*3 + i] = p[i];
+    }
+  }
+
+  void LalibeCorrelatorBuffer::add(const std::string& name, int mom, const multi1d<Complex>& correlator)
+  {
+    std::map<std::string, int>::iterator it = name_index.find(name);
+    if(it == name_index.end())
+    {
+      it = name_index.insert(std::make_pair(name, int(names.size()))).first;
+      names.push_back(name);
+      data.push_back(multi1d<Complex>(num_mom*Nt));
+      data.back() = zero;
+    }
+    multi1d<Complex>& corr = data[it->second];
+    for(int t = 0; t < Nt; t++)
+      corr[mom*Nt + t] = correlator[t];
+  }
+
+  void LalibeCorrelatorBuffer::write(const std::string& path, const multi1d<int>& source_coords,
+				     HDF5Writer& h5writer, HDF5Base::writemode& h5mode)
+  {
+    if(names.size() == 0)
+      return;
+
+    std::string group = path+"/x"+std::to_string(source_coords[0])+"_y"+std::to_string(source_coords[1])+"_z"+std::to_string(source_coords[2])+"_t"+std::to_string(source_coords[3]);
+    h5writer.push(group);
+
+    multi1d<Complex> correlators(names.size()*num_mom*Nt);
+    std::string name_list;
+    for(int c = 0; c < names.size(); c++)
+    {
+      for(int i = 0; i < num_mom*Nt; i++)
+	correlators[c*num_mom*Nt + i] = data[c][i];
+      name_list += names[c]+"\n";
+    }
+    multi1d<int> shape(3);
+    shape[0] = names.size();
+    shape[1] = num_mom;
+    shape[2] = Nt;
+
+    QDPIO::cout<<"Writing "<<names.size()<<" correlators at "<<num_mom<<" momenta to "<<group<<std::endl;
+    h5writer.write(group+"/correlators", correlators, h5mode);
+    h5writer.writeAttribute(group+"/correlators", "is_shifted", 1, h5mode);
+    h5writer.writeAttribute(group+"/correlators", "names", name_list, h5mode);
+    h5writer.write(group+"/momenta", momenta, h5mode);
+    h5writer.write(group+"/shape", shape, h5mode);
+    h5writer.cd("/");
+
+    names.clear();
+    name_index.clear();
+    data.clear();
+  }
+}
+
+#endif
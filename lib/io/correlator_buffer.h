@@ -0,0 +1,54 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Momentum projected correlators of a task, held in memory and written as one dataset
+ */
+
+//Protect everything with a preprocessing directive.
+#ifdef BUILD_HDF5
+
+#ifndef __correlator_buffer_h__
+#define __correlator_buffer_h__
+
+#include "chromabase.h"
+#include "../momentum/lalibe_sftmom.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Chroma
+{
+  //! Collects the shifted, projected correlators of one source instead of one dataset per momentum
+  /*!
+   * write() puts everything under path/x<x>_y<y>_z<z>_t<t>:
+   *   correlators  [correlator][mom][t] complex, flattened, is_shifted attribute as before
+   *   momenta      [mom][3] int, flattened, in LalibeSftMom order
+   *   shape        the three dimensions of correlators
+   * The correlator names, in the order they were first added, are the "names" attribute of
+   * correlators, one per line, in the same form as the group paths of the per-momentum output.
+   */
+  class LalibeCorrelatorBuffer
+  {
+  public:
+    LalibeCorrelatorBuffer(LalibeSftMom& FT, int Nt);
+
+    //! Correlator name at momentum mom, already shifted to the source time
+    void add(const std::string& name, int mom, const multi1d<Complex>& correlator);
+
+    //! Write what is held and forget it
+    void write(const std::string& path, const multi1d<int>& source_coords,
+	       HDF5Writer& h5writer, HDF5Base::writemode& h5mode);
+
+  private:
+    int num_mom;
+    int Nt;
+    multi1d<int> momenta;
+    std::vector<std::string> names;
+    std::map<std::string, int> name_index;
+    std::vector<multi1d<Complex>> data;     //[mom][t] of each name, flattened
+  };
+}
+
+#endif
+
+#endif
@@ -0,0 +1,179 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Named object writes staged in memory and done together at the next flush
+ */
+
+//Protect everything with a preprocessing directive.
+#ifdef BUILD_HDF5
+
+#include "meas/inline/io/named_objmap.h"
+
+#include "hdf5_output_queue.h"
+#include "hdf5_write_obj_funcmap.h"
+
+#include <deque>
+#include <sstream>
+
+namespace Chroma
+{
+  namespace
+  {
+    //! A staged write and the private named object holding its copy
+    struct StagedEntry
+    {
+      LalibeStagedWrite write;
+      std::string staged_id;
+      double mb;
+    };
+
+    std::deque<StagedEntry>& stagedWrites()
+    {
+      static std::deque<StagedEntry> staged;
+      return staged;
+    }
+
+    double& stagedMB()
+    {
+      static double mb = 0;
+      return mb;
+    }
+
+    //! Copy a named object, with its file and record XML, to a new id
+    template<typename T>
+    void copyObject(const std::string& from_id, const std::string& to_id)
+    {
+      XMLBufferWriter file_xml, record_xml;
+      TheNamedObjMap::Instance().get(from_id).getFileXML(file_xml);
+      TheNamedObjMap::Instance().get(from_id).getRecordXML(record_xml);
+
+      TheNamedObjMap::Instance().create<T>(to_id);
+      TheNamedObjMap::Instance().getData<T>(to_id) = TheNamedObjMap::Instance().getData<T>(from_id);
+      TheNamedObjMap::Instance().get(to_id).setFileXML(file_xml);
+      TheNamedObjMap::Instance().get(to_id).setRecordXML(record_xml);
+    }
+
+    //! Per node MB of a staged copy. The writer funcmap types name the file
+    //! precision, in memory they are all in the build precision.
+    double objectMB(const std::string& type)
+    {
+      double reals;
+      if (type.find("StaggeredPropagator") != std::string::npos)
+	reals = Nc*Nc*2;
+      else if (type.find("Propagator") != std::string::npos)
+	reals = Ns*Ns*Nc*Nc*2;
+      else if (type.find("Fermion") != std::string::npos)
+	reals = Ns*Nc*2;
+      else
+	reals = Nd*Nc*Nc*2;
+      return double(Layout::sitesOnNode())*reals*sizeof(REAL)/(1024.0*1024.0);
+    }
+
+    //! Copy object_id, of a writer funcmap type, to staged_id
+    void stageObject(const std::string& type, const std::string& object_id, const std::string& staged_id)
+    {
+      if (type.find("StaggeredPropagator") != std::string::npos)
+	copyObject<LatticeStaggeredPropagator>(object_id, staged_id);
+      else if (type.find("Propagator") != std::string::npos)
+	copyObject<LatticePropagator>(object_id, staged_id);
+      else if (type.find("Fermion") != std::string::npos)
+	copyObject<LatticeFermion>(object_id, staged_id);
+      else if (type.find("Multi1dLatticeColorMatrix") != std::string::npos)
+	copyObject< multi1d<LatticeColorMatrix> >(object_id, staged_id);
+      else
+      {
+	QDPIO::cerr << __func__ << ": cannot stage objects of type " << type << std::endl;
+	QDP_abort(1);
+      }
+    }
+
+    void writeObject(const std::string& object_id, const LalibeStagedWrite& staged)
+    {
+      HDF5Base::writemode wmode = HDF5Base::ate;
+      HDF5WriteObjCallMapEnv::TheHDF5WriteObjFuncMap::Instance().callFunction(staged.object_type,
+									    object_id,
+									    staged.file_name,
+									    staged.obj_name,
+									    staged.path, wmode);
+    }
+
+    void doWrite(const StagedEntry& entry)
+    {
+      QDPIO::cout << "Writing staged copy of " << entry.write.object_id << " to " << entry.write.file_name << std::endl;
+      writeObject(entry.staged_id, entry.write);
+      TheNamedObjMap::Instance().erase(entry.staged_id);
+      stagedMB() -= entry.mb;
+    }
+  }
+
+  void lalibeStageHDF5Write(const LalibeStagedWrite& staged, double max_staged_mb)
+  {
+    static unsigned long num_staged = 0;
+
+    if (! TheNamedObjMap::Instance().check(staged.object_id))
+    {
+      QDPIO::cerr << __func__ << ": object " << staged.object_id << " is not in the named object map" << std::endl;
+      QDP_abort(1);
+    }
+
+    // An object over the limit on its own is written right away
+    double mb = objectMB(staged.object_type);
+    if (max_staged_mb > 0 && mb > max_staged_mb)
+    {
+      QDPIO::cout << staged.object_id << " is larger than max_staged_mb, writing it now" << std::endl;
+      writeObject(staged.object_id, staged);
+      return;
+    }
+
+    // Make room by writing out the oldest copies first
+    std::deque<StagedEntry>& queue = stagedWrites();
+    while (max_staged_mb > 0 && stagedMB() + mb > max_staged_mb && ! queue.empty())
+    {
+      StagedEntry oldest = queue.front();
+      queue.pop_front();
+      doWrite(oldest);
+    }
+
+    std::ostringstream id;
+    id << "lalibe_staged_write_" << num_staged++;
+
+    StagedEntry entry;
+    entry.write = staged;
+    entry.staged_id = id.str();
+    entry.mb = mb;
+    stageObject(staged.object_type, staged.object_id, entry.staged_id);
+    queue.push_back(entry);
+    stagedMB() += mb;
+
+    QDPIO::cout << "Staged write of " << staged.object_id << ", " << queue.size() << " writes ("
+		<< stagedMB() << " MB per node) now staged" << std::endl;
+  }
+
+  void lalibeDrainHDF5Writes(const std::string& file_name)
+  {
+    std::deque<StagedEntry>& queue = stagedWrites();
+    std::deque<StagedEntry> others;
+    while (! queue.empty())
+    {
+      StagedEntry entry = queue.front();
+      queue.pop_front();
+      if (entry.write.file_name == file_name)
+	doWrite(entry);
+      else
+	others.push_back(entry);
+    }
+    queue.swap(others);
+  }
+
+  void lalibeDrainHDF5Writes()
+  {
+    std::deque<StagedEntry>& queue = stagedWrites();
+    while (! queue.empty())
+    {
+      StagedEntry entry = queue.front();
+      queue.pop_front();
+      doWrite(entry);
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,47 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Named object writes staged in memory and done together at the next flush
+ */
+
+//Protect everything with a preprocessing directive.
+#ifdef BUILD_HDF5
+
+#ifndef __hdf5_output_queue_h__
+#define __hdf5_output_queue_h__
+
+#include "chromabase.h"
+
+#include <string>
+
+namespace Chroma
+{
+  //! One HDF5_WRITE_NAMED_OBJECT write waiting to be done
+  struct LalibeStagedWrite
+  {
+    std::string object_id;
+    std::string object_type;
+    std::string file_name;
+    std::string path;
+    std::string obj_name;
+  };
+
+  //! Stage a write instead of doing it now
+  /*!
+   * The object, with its file and record XML, is copied into the staging buffer right away, so later
+   * measurements are free to change, re-create or erase object_id. Staged writes are done, in the order
+   * they were staged, when their file is closed (HDF5_FLUSH, a read of the file, the end of the run).
+   * If the staging buffer would go over max_staged_mb per node (<= 0 is no limit), the oldest staged
+   * writes are done first to make room.
+   */
+  void lalibeStageHDF5Write(const LalibeStagedWrite& staged, double max_staged_mb);
+
+  //! Do the staged writes to file_name
+  void lalibeDrainHDF5Writes(const std::string& file_name);
+
+  //! Do every staged write
+  void lalibeDrainHDF5Writes();
+}
+
+#endif
+
+#endif
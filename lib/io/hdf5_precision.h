@@ -0,0 +1,58 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Writing and reading lattice objects in a file precision other than the build's
+ */
+
+//Protect everything with a preprocessing directive.
+#ifdef BUILD_HDF5
+
+#ifndef __hdf5_precision_h__
+#define __hdf5_precision_h__
+
+#include "chromabase.h"
+
+#include <string>
+
+namespace Chroma
+{
+  //! Write or read a T stored in the file as a TFile
+  /*!
+   * A converted copy is only made when the two types differ, a D object in a double build or
+   * an F object in a single build goes straight from or into the caller's object.
+   */
+  template<typename TFile, typename T>
+  struct LalibeHDF5Precision
+  {
+    static void write(HDF5Writer& h5out, const std::string& path, const T& obj, HDF5Base::writemode wmode)
+    {
+      TFile converted;
+      converted = obj;
+      h5out.write(path, converted, wmode);
+    }
+
+    static void read(HDF5Reader& reader, const std::string& path, T& obj)
+    {
+      TFile converted;
+      reader.read(path, converted);
+      obj = converted;
+    }
+  };
+
+  template<typename T>
+  struct LalibeHDF5Precision<T, T>
+  {
+    static void write(HDF5Writer& h5out, const std::string& path, const T& obj, HDF5Base::writemode wmode)
+    {
+      h5out.write(path, obj, wmode);
+    }
+
+    static void read(HDF5Reader& reader, const std::string& path, T& obj)
+    {
+      reader.read(path, obj);
+    }
+  };
+}
+
+#endif
+
+#endif
@@ -0,0 +1,60 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief HDF5 I/O settings read from the input instead of compiled in
+ */
+
+//Protect everything with a preprocessing directive.
+#ifdef BUILD_HDF5
+
+#include "hdf5_tuning.h"
+
+#include <map>
+
+namespace Chroma
+{
+  namespace
+  {
+    std::map<std::string, LalibeHDF5Tuning>& fileTunings()
+    {
+      static std::map<std::string, LalibeHDF5Tuning> tunings;
+      return tunings;
+    }
+  }
+
+  LalibeHDF5Tuning::LalibeHDF5Tuning() : stripesize(1048576) {}
+
+  void read(XMLReader& xml, const std::string& path, LalibeHDF5Tuning& tuning)
+  {
+    XMLReader paramtop(xml, path);
+
+    tuning = LalibeHDF5Tuning();
+    if (paramtop.count("stripesize") != 0)
+      read(paramtop, "stripesize", tuning.stripesize);
+    if (tuning.stripesize <= 0)
+    {
+      QDPIO::cerr << __func__ << ": stripesize must be positive, got " << tuning.stripesize << std::endl;
+      QDP_abort(1);
+    }
+  }
+
+  void write(XMLWriter& xml, const std::string& path, const LalibeHDF5Tuning& tuning)
+  {
+    push(xml, path);
+    write(xml, "stripesize", tuning.stripesize);
+    pop(xml);
+  }
+
+  void lalibeSetHDF5Tuning(const std::string& file_name, const LalibeHDF5Tuning& tuning)
+  {
+    fileTunings()[file_name] = tuning;
+  }
+
+  const LalibeHDF5Tuning& lalibeHDF5Tuning(const std::string& file_name)
+  {
+    static const LalibeHDF5Tuning defaults;
+    std::map<std::string, LalibeHDF5Tuning>::const_iterator it = fileTunings().find(file_name);
+    return it == fileTunings().end() ? defaults : it->second;
+  }
+}
+
+#endif
@@ -0,0 +1,43 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief HDF5 I/O settings read from the input instead of compiled in
+ */
+
+//Protect everything with a preprocessing directive.
+#ifdef BUILD_HDF5
+
+#ifndef __hdf5_tuning_h__
+#define __hdf5_tuning_h__
+
+#include "chromabase.h"
+
+#include <string>
+
+namespace Chroma
+{
+  //! The optional HDF5Tuning block of the HDF5 read and write tasks
+  /*!
+   * stripesize is the HDF5Base stripe size in bytes given to the writer or reader of a lattice
+   * object, 1048576 (1MB) unless set. It is the only layout setting QDP++'s HDF5Base lets a caller
+   * change, the file access properties are fixed when it opens the file.
+   */
+  struct LalibeHDF5Tuning
+  {
+    LalibeHDF5Tuning();
+
+    int stripesize;
+  };
+
+  void read(XMLReader& xml, const std::string& path, LalibeHDF5Tuning& tuning);
+  void write(XMLWriter& xml, const std::string& path, const LalibeHDF5Tuning& tuning);
+
+  //! Use tuning for every later write to file_name
+  void lalibeSetHDF5Tuning(const std::string& file_name, const LalibeHDF5Tuning& tuning);
+
+  //! The tuning of file_name, the defaults if none was set
+  const LalibeHDF5Tuning& lalibeHDF5Tuning(const std::string& file_name);
+}
+
+#endif
+
+#endif
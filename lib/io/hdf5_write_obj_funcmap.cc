@@ -19,6 +19,9 @@
 
 //LALIBE stuff...
 #include "hdf5_write_obj_funcmap.h"
+#include "hdf5_writer_cache.h"
+#include "hdf5_tuning.h"
+#include "hdf5_precision.h"
 
 namespace Chroma
 {
@@ -37,19 +40,19 @@ namespace Chroma
 			   const std::string& obj_name,
 			   const std::string& path, HDF5Base::writemode wmode)
       {
-	LatticePropagator obj;
 	//XMLReader file_xml, record_xml;
 	XMLBufferWriter file_xml, record_xml;
 
 	//obj = TheNamedObjMap::Instance().getData<LatticePropagatorD3>(buffer_id);
-	obj = TheNamedObjMap::Instance().getData<LatticePropagator>(buffer_id);
+	//Written straight from the stored object, no copy.
+	const LatticePropagator& obj = TheNamedObjMap::Instance().getData<LatticePropagator>(buffer_id);
 	TheNamedObjMap::Instance().get(buffer_id).getFileXML(file_xml);
 	TheNamedObjMap::Instance().get(buffer_id).getRecordXML(record_xml);
 
-	HDF5Writer h5out(outputfile);
+	HDF5Writer& h5out = lalibeHDF5Writer(outputfile);
 	h5out.push(path);
 	std::string propagator_path = path+"/"+obj_name;
-	h5out.set_stripesize(1048576); // MAGIC NUMBER ALERT!  1048576 = 1024^2 = 1MB
+	h5out.set_stripesize(lalibeHDF5Tuning(outputfile).stripesize);
 	h5out.write(propagator_path, obj, wmode);
 	std::string record = record_xml.str();
 	std::string file = file_xml.str();
@@ -82,8 +85,6 @@ namespace Chroma
 	h5out.writeAttribute(propagator_path, "record_xml_formatted", record_formatted, wmode);
 
 	h5out.cd("/");
-	h5out.close();
-
       }
 
       //! Write a single prec propagator
@@ -93,18 +94,17 @@ namespace Chroma
 			   const std::string& path, HDF5Base::writemode wmode)
       {
     //LatticeDiracPropagatorF3 obj;
-	LatticePropagatorF obj;
 	XMLBufferWriter file_xml, record_xml;
 
-	obj = TheNamedObjMap::Instance().getData<LatticePropagator>(buffer_id);
+	const LatticePropagator& obj = TheNamedObjMap::Instance().getData<LatticePropagator>(buffer_id);
 	TheNamedObjMap::Instance().get(buffer_id).getFileXML(file_xml);
 	TheNamedObjMap::Instance().get(buffer_id).getRecordXML(record_xml);
 	
-	HDF5Writer h5out(outputfile);
+	HDF5Writer& h5out = lalibeHDF5Writer(outputfile);
 	h5out.push(path);
 	std::string propagator_path = path+"/"+obj_name;
-	h5out.set_stripesize(1048576); // MAGIC NUMBER ALERT!  1048576 = 1024^2 = 1MB
-	h5out.write(propagator_path, obj, wmode);
+	h5out.set_stripesize(lalibeHDF5Tuning(outputfile).stripesize);
+	LalibeHDF5Precision<LatticePropagatorF, LatticePropagator>::write(h5out, propagator_path, obj, wmode);
 	std::string record = record_xml.str();
 	std::string file = file_xml.str();
 	//This string needs to be broadcasted, right now only the head node has it.
@@ -136,8 +136,6 @@ namespace Chroma
 	h5out.writeAttribute(propagator_path, "record_xml_formatted", record_formatted, wmode);
 
 	h5out.cd("/");
-	h5out.close();
-
       }
 
 
@@ -147,18 +145,17 @@ namespace Chroma
 			   const std::string& obj_name,
 			   const std::string& path, HDF5Base::writemode wmode)
       {
-	LatticePropagatorD obj;
 	XMLBufferWriter file_xml, record_xml;
 
-	obj = TheNamedObjMap::Instance().getData<LatticePropagator>(buffer_id);
+	const LatticePropagator& obj = TheNamedObjMap::Instance().getData<LatticePropagator>(buffer_id);
 	TheNamedObjMap::Instance().get(buffer_id).getFileXML(file_xml);
 	TheNamedObjMap::Instance().get(buffer_id).getRecordXML(record_xml);
 
-	HDF5Writer h5out(outputfile);
+	HDF5Writer& h5out = lalibeHDF5Writer(outputfile);
 	h5out.push(path);
 	std::string propagator_path = path+"/"+obj_name;
-	h5out.set_stripesize(1048576); // MAGIC NUMBER ALERT!  1048576 = 1024^2 = 1MB
-	h5out.write(propagator_path, obj, wmode);
+	h5out.set_stripesize(lalibeHDF5Tuning(outputfile).stripesize);
+	LalibeHDF5Precision<LatticePropagatorD, LatticePropagator>::write(h5out, propagator_path, obj, wmode);
 	std::string record = record_xml.str();
 	std::string file = file_xml.str();
 	//This string needs to be broadcasted, right now only the head node has it.
@@ -190,8 +187,6 @@ namespace Chroma
 	h5out.writeAttribute(propagator_path, "record_xml_formatted", record_formatted, wmode);
 
 	h5out.cd("/");
-	h5out.close();
-
       }
       //! Write the upper two components of a non-relativistic half-spin propagator
       void HDF5WriteUpperLatProp(const std::string& buffer_id,
@@ -199,10 +194,9 @@ namespace Chroma
 			   const std::string& obj_name,
 			   const std::string& path, HDF5Base::writemode wmode)
       {
-	LatticePropagator obj;
 	XMLBufferWriter file_xml, record_xml;
 
-	obj = TheNamedObjMap::Instance().getData<LatticePropagator>(buffer_id);
+	const LatticePropagator& obj = TheNamedObjMap::Instance().getData<LatticePropagator>(buffer_id);
 	TheNamedObjMap::Instance().get(buffer_id).getFileXML(file_xml);
 	TheNamedObjMap::Instance().get(buffer_id).getRecordXML(record_xml);
 
@@ -230,11 +224,11 @@ namespace Chroma
 	  }
 	}
 
-	HDF5Writer h5out(outputfile);
+	HDF5Writer& h5out = lalibeHDF5Writer(outputfile);
 	//h5out.push(path);
 	std::string propagator_path = path+"/"+obj_name;
 	h5out.push(propagator_path); //We want to push here since each spin component will be written separately.
-	h5out.set_stripesize(1048576); // MAGIC NUMBER ALERT!  1048576 = 1024^2 = 1MB
+	h5out.set_stripesize(lalibeHDF5Tuning(outputfile).stripesize);
 	//Loop over the the upper spin components and write them.
 	for(int color_source = 0; color_source < Nc ; ++color_source) 
 	{
@@ -279,9 +273,8 @@ namespace Chroma
 	    h5out.writeAttribute(fermion_path, "record_xml_formatted", record_formatted, wmode);
 	  }
 	}
-	//The h5 file needs to be closed outside of this loop.
+	//Back to the root group outside of this loop, the file itself stays open.
 	h5out.cd("/");
-	h5out.close();
       }
       
       //! Write the upper two components of a non-relativistic half-spin propagator
@@ -290,10 +283,10 @@ namespace Chroma
 			   const std::string& obj_name,
 			   const std::string& path, HDF5Base::writemode wmode)
       {
-	LatticePropagatorF obj;
 	XMLBufferWriter file_xml, record_xml;
 
-	obj = TheNamedObjMap::Instance().getData<LatticePropagator>(buffer_id);
+	//Only one spin-color component at a time is converted to the file precision.
+	const LatticePropagator& obj = TheNamedObjMap::Instance().getData<LatticePropagator>(buffer_id);
 	TheNamedObjMap::Instance().get(buffer_id).getFileXML(file_xml);
 	TheNamedObjMap::Instance().get(buffer_id).getRecordXML(record_xml);
 
@@ -304,8 +297,8 @@ namespace Chroma
 	  for(int spin_source = Ns/2; spin_source < Ns; ++spin_source) 
 	  { 
 	    int original_spin = spin_source - Ns/2;
-	    LatticeFermionF psi;
-	    LatticeFermionF chi;
+	    LatticeFermion psi;
+	    LatticeFermion chi;
 
 	    PropToFerm(obj, psi, color_source, original_spin);
 	    PropToFerm(obj, chi, color_source, spin_source);
@@ -321,25 +314,25 @@ namespace Chroma
 	  }
 	}
 
-	HDF5Writer h5out(outputfile);
+	HDF5Writer& h5out = lalibeHDF5Writer(outputfile);
 	//h5out.push(path);
 	std::string propagator_path = path+"/"+obj_name;
 	h5out.push(propagator_path); //We want to push here since each spin component will be written separately.
-	h5out.set_stripesize(1048576); // MAGIC NUMBER ALERT!  1048576 = 1024^2 = 1MB
+	h5out.set_stripesize(lalibeHDF5Tuning(outputfile).stripesize);
 	//Loop over the the upper spin components and write them.
 	for(int color_source = 0; color_source < Nc ; ++color_source) 
 	{
 	  for(int spin_source = Ns/2; spin_source < Ns; ++spin_source) 
 	  { 
 	    int original_spin = spin_source - Ns/2;
-	    LatticeFermionF psi;
+	    LatticeFermion psi;
 
 	    PropToFerm(obj, psi, color_source, original_spin);
 
 	    std::string fermion_path = propagator_path+"/color_"+std::to_string(color_source)+"_spin_"+std::to_string(original_spin);
 	    QDPIO::cout<<"Writing color: "<<color_source<<" spin: "<<original_spin<<std::endl;
 	    //Now all the usual stuff happens, only difference is we are writing a fermion.
-	    h5out.write(fermion_path, psi, wmode);
+	    h5out.write(fermion_path, LatticeFermionF(psi), wmode);
 	    std::string record = record_xml.str();
 	    std::string file = file_xml.str();
 	    //This string needs to be broadcasted, right now only the head node has it.
@@ -370,9 +363,8 @@ namespace Chroma
 	    h5out.writeAttribute(fermion_path, "record_xml_formatted", record_formatted, wmode);
 	  }
 	}
-	//The h5 file needs to be closed outside of this loop.
+	//Back to the root group outside of this loop, the file itself stays open.
 	h5out.cd("/");
-	h5out.close();
       }
       
       //! Write the upper two components of a non-relativistic half-spin propagator
@@ -381,10 +373,9 @@ namespace Chroma
 			   const std::string& obj_name,
 			   const std::string& path, HDF5Base::writemode wmode)
       {
-	LatticePropagatorD obj;
 	XMLBufferWriter file_xml, record_xml;
 
-	obj = TheNamedObjMap::Instance().getData<LatticePropagator>(buffer_id);
+	const LatticePropagator& obj = TheNamedObjMap::Instance().getData<LatticePropagator>(buffer_id);
 	TheNamedObjMap::Instance().get(buffer_id).getFileXML(file_xml);
 	TheNamedObjMap::Instance().get(buffer_id).getRecordXML(record_xml);
 
@@ -395,8 +386,8 @@ namespace Chroma
 	  for(int spin_source = Ns/2; spin_source < Ns; ++spin_source) 
 	  { 
 	    int original_spin = spin_source - Ns/2;
-	    LatticeFermionD psi;
-	    LatticeFermionD chi;
+	    LatticeFermion psi;
+	    LatticeFermion chi;
 
 	    PropToFerm(obj, psi, color_source, original_spin);
 	    PropToFerm(obj, chi, color_source, spin_source);
@@ -412,25 +403,25 @@ namespace Chroma
 	  }
 	}
 
-	HDF5Writer h5out(outputfile);
+	HDF5Writer& h5out = lalibeHDF5Writer(outputfile);
 	//h5out.push(path);
 	std::string propagator_path = path+"/"+obj_name;
 	h5out.push(propagator_path); //We want to push here since each spin component will be written separately.
-	h5out.set_stripesize(1048576); // MAGIC NUMBER ALERT!  1048576 = 1024^2 = 1MB
+	h5out.set_stripesize(lalibeHDF5Tuning(outputfile).stripesize);
 	//Loop over the the upper spin components and write them.
 	for(int color_source = 0; color_source < Nc ; ++color_source) 
 	{
 	  for(int spin_source = Ns/2; spin_source < Ns; ++spin_source) 
 	  { 
 	    int original_spin = spin_source - Ns/2;
-	    LatticeFermionD psi;
+	    LatticeFermion psi;
 
 	    PropToFerm(obj, psi, color_source, original_spin);
 
 	    std::string fermion_path = propagator_path+"/color_"+std::to_string(color_source)+"_spin_"+std::to_string(original_spin);
 	    QDPIO::cout<<"Writing color: "<<color_source<<" spin: "<<original_spin<<std::endl;
 	    //Now all the usual stuff happens, only difference is we are writing a fermion.
-	    h5out.write(fermion_path, psi, wmode);
+	    h5out.write(fermion_path, LatticeFermionD(psi), wmode);
 	    std::string record = record_xml.str();
 	    std::string file = file_xml.str();
 	    //This string needs to be broadcasted, right now only the head node has it.
@@ -461,9 +452,8 @@ namespace Chroma
 	    h5out.writeAttribute(fermion_path, "record_xml_formatted", record_formatted, wmode);
 	  }
 	}
-	//The h5 file needs to be closed outside of this loop.
+	//Back to the root group outside of this loop, the file itself stays open.
 	h5out.cd("/");
-	h5out.close();
       }
       
       //! Write the lower two components of a non-relativistic half-spin propagator
@@ -472,10 +462,9 @@ namespace Chroma
 			   const std::string& obj_name,
 			   const std::string& path, HDF5Base::writemode wmode)
       {
-	LatticePropagator obj;
 	XMLBufferWriter file_xml, record_xml;
 
-	obj = TheNamedObjMap::Instance().getData<LatticePropagator>(buffer_id);
+	const LatticePropagator& obj = TheNamedObjMap::Instance().getData<LatticePropagator>(buffer_id);
 	TheNamedObjMap::Instance().get(buffer_id).getFileXML(file_xml);
 	TheNamedObjMap::Instance().get(buffer_id).getRecordXML(record_xml);
 
@@ -503,11 +492,11 @@ namespace Chroma
 	  }
 	}
 
-	HDF5Writer h5out(outputfile);
+	HDF5Writer& h5out = lalibeHDF5Writer(outputfile);
 	//h5out.push(path);
 	std::string propagator_path = path+"/"+obj_name;
 	h5out.push(propagator_path); //We want to push here since each spin component will be written separately.
-	h5out.set_stripesize(1048576); // MAGIC NUMBER ALERT!  1048576 = 1024^2 = 1MB
+	h5out.set_stripesize(lalibeHDF5Tuning(outputfile).stripesize);
 	//Loop over the the upper spin components and write them.
 	for(int color_source = 0; color_source < Nc ; ++color_source) 
 	{
@@ -552,9 +541,8 @@ namespace Chroma
 	    h5out.writeAttribute(fermion_path, "record_xml_formatted", record_formatted, wmode);
 	  }
 	}
-	//The h5 file needs to be closed outside of this loop.
+	//Back to the root group outside of this loop, the file itself stays open.
 	h5out.cd("/");
-	h5out.close();
       }
       
       //! Write the lower two components of a non-relativistic half-spin propagator
@@ -563,10 +551,9 @@ namespace Chroma
 			   const std::string& obj_name,
 			   const std::string& path, HDF5Base::writemode wmode)
       {
-	LatticePropagatorF obj;
 	XMLBufferWriter file_xml, record_xml;
 
-	obj = TheNamedObjMap::Instance().getData<LatticePropagator>(buffer_id);
+	const LatticePropagator& obj = TheNamedObjMap::Instance().getData<LatticePropagator>(buffer_id);
 	TheNamedObjMap::Instance().get(buffer_id).getFileXML(file_xml);
 	TheNamedObjMap::Instance().get(buffer_id).getRecordXML(record_xml);
 
@@ -577,8 +564,8 @@ namespace Chroma
 	  for(int spin_source = 0; spin_source < Ns/2; ++spin_source) 
 	  { 
 	    int original_spin = spin_source + Ns/2;
-	    LatticeFermionF psi;
-	    LatticeFermionF chi;
+	    LatticeFermion psi;
+	    LatticeFermion chi;
 
 	    PropToFerm(obj, psi, color_source, original_spin);
 	    PropToFerm(obj, chi, color_source, spin_source);
@@ -594,25 +581,25 @@ namespace Chroma
 	  }
 	}
 
-	HDF5Writer h5out(outputfile);
+	HDF5Writer& h5out = lalibeHDF5Writer(outputfile);
 	//h5out.push(path);
 	std::string propagator_path = path+"/"+obj_name;
 	h5out.push(propagator_path); //We want to push here since each spin component will be written separately.
-	h5out.set_stripesize(1048576); // MAGIC NUMBER ALERT!  1048576 = 1024^2 = 1MB
+	h5out.set_stripesize(lalibeHDF5Tuning(outputfile).stripesize);
 	//Loop over the the upper spin components and write them.
 	for(int color_source = 0; color_source < Nc ; ++color_source) 
 	{
 	  for(int spin_source = 0; spin_source < Ns/2; ++spin_source) 
 	  { 
 	    int original_spin = spin_source + Ns/2;
-	    LatticeFermionF psi;
+	    LatticeFermion psi;
 
 	    PropToFerm(obj, psi, color_source, original_spin);
 
 	    std::string fermion_path = propagator_path+"/color_"+std::to_string(color_source)+"_spin_"+std::to_string(original_spin);
 	    QDPIO::cout<<"Writing color: "<<color_source<<" spin: "<<original_spin<<std::endl;
 	    //Now all the usual stuff happens, only difference is we are writing a fermion.
-	    h5out.write(fermion_path, psi, wmode);
+	    h5out.write(fermion_path, LatticeFermionF(psi), wmode);
 	    std::string record = record_xml.str();
 	    std::string file = file_xml.str();
 	    //This string needs to be broadcasted, right now only the head node has it.
@@ -643,9 +630,8 @@ namespace Chroma
 	    h5out.writeAttribute(fermion_path, "record_xml_formatted", record_formatted, wmode);
 	  }
 	}
-	//The h5 file needs to be closed outside of this loop.
+	//Back to the root group outside of this loop, the file itself stays open.
 	h5out.cd("/");
-	h5out.close();
       }
       
       //! Write the lower two components of a non-relativistic half-spin propagator
@@ -654,10 +640,9 @@ namespace Chroma
 			   const std::string& obj_name,
 			   const std::string& path, HDF5Base::writemode wmode)
       {
-	LatticePropagatorD obj;
 	XMLBufferWriter file_xml, record_xml;
 
-	obj = TheNamedObjMap::Instance().getData<LatticePropagator>(buffer_id);
+	const LatticePropagator& obj = TheNamedObjMap::Instance().getData<LatticePropagator>(buffer_id);
 	TheNamedObjMap::Instance().get(buffer_id).getFileXML(file_xml);
 	TheNamedObjMap::Instance().get(buffer_id).getRecordXML(record_xml);
 
@@ -668,8 +653,8 @@ namespace Chroma
 	  for(int spin_source = 0; spin_source < Ns/2; ++spin_source) 
 	  { 
 	    int original_spin = spin_source + Ns/2;
-	    LatticeFermionD psi;
-	    LatticeFermionD chi;
+	    LatticeFermion psi;
+	    LatticeFermion chi;
 
 	    PropToFerm(obj, psi, color_source, original_spin);
 	    PropToFerm(obj, chi, color_source, spin_source);
@@ -685,25 +670,25 @@ namespace Chroma
 	  }
 	}
 
-	HDF5Writer h5out(outputfile);
+	HDF5Writer& h5out = lalibeHDF5Writer(outputfile);
 	//h5out.push(path);
 	std::string propagator_path = path+"/"+obj_name;
 	h5out.push(propagator_path); //We want to push here since each spin component will be written separately.
-	h5out.set_stripesize(1048576); // MAGIC NUMBER ALERT!  1048576 = 1024^2 = 1MB
+	h5out.set_stripesize(lalibeHDF5Tuning(outputfile).stripesize);
 	//Loop over the the upper spin components and write them.
 	for(int color_source = 0; color_source < Nc ; ++color_source) 
 	{
 	  for(int spin_source = 0; spin_source < Ns/2; ++spin_source) 
 	  { 
 	    int original_spin = spin_source + Ns/2;
-	    LatticeFermionD psi;
+	    LatticeFermion psi;
 
 	    PropToFerm(obj, psi, color_source, original_spin);
 
 	    std::string fermion_path = propagator_path+"/color_"+std::to_string(color_source)+"_spin_"+std::to_string(original_spin);
 	    QDPIO::cout<<"Writing color: "<<color_source<<" spin: "<<original_spin<<std::endl;
 	    //Now all the usual stuff happens, only difference is we are writing a fermion.
-	    h5out.write(fermion_path, psi, wmode);
+	    h5out.write(fermion_path, LatticeFermionD(psi), wmode);
 	    std::string record = record_xml.str();
 	    std::string file = file_xml.str();
 	    //This string needs to be broadcasted, right now only the head node has it.
@@ -734,9 +719,8 @@ namespace Chroma
 	    h5out.writeAttribute(fermion_path, "record_xml_formatted", record_formatted, wmode);
 	  }
 	}
-	//The h5 file needs to be closed outside of this loop.
+	//Back to the root group outside of this loop, the file itself stays open.
 	h5out.cd("/");
-	h5out.close();
       }
 
 
@@ -746,17 +730,16 @@ namespace Chroma
 			   const std::string& obj_name,
 			   const std::string& path, HDF5Base::writemode wmode)
       {
-	LatticeFermion obj;
 	XMLBufferWriter file_xml, record_xml;
 
-	obj = TheNamedObjMap::Instance().getData<LatticeFermion>(buffer_id);
+	const LatticeFermion& obj = TheNamedObjMap::Instance().getData<LatticeFermion>(buffer_id);
 	TheNamedObjMap::Instance().get(buffer_id).getFileXML(file_xml);
 	TheNamedObjMap::Instance().get(buffer_id).getRecordXML(record_xml);
 
-	HDF5Writer h5out(outputfile);
+	HDF5Writer& h5out = lalibeHDF5Writer(outputfile);
 	h5out.push(path);
 	std::string propagator_path = path+"/"+obj_name;
-	h5out.set_stripesize(1048576); // MAGIC NUMBER ALERT!  1048576 = 1024^2 = 1MB
+	h5out.set_stripesize(lalibeHDF5Tuning(outputfile).stripesize);
 	h5out.write(propagator_path, obj, wmode);
 	std::string record = record_xml.str();
 	std::string file = file_xml.str();
@@ -789,8 +772,6 @@ namespace Chroma
 	h5out.writeAttribute(propagator_path, "record_xml_formatted", record_formatted, wmode);
 
 	h5out.cd("/");
-	h5out.close();
-
       }
 
 
@@ -800,18 +781,17 @@ namespace Chroma
 			   const std::string& obj_name,
 			   const std::string& path, HDF5Base::writemode wmode)
       {
-	LatticeFermionF obj;
 	XMLBufferWriter file_xml, record_xml;
 
-	obj = TheNamedObjMap::Instance().getData<LatticeFermion>(buffer_id);
+	const LatticeFermion& obj = TheNamedObjMap::Instance().getData<LatticeFermion>(buffer_id);
 	TheNamedObjMap::Instance().get(buffer_id).getFileXML(file_xml);
 	TheNamedObjMap::Instance().get(buffer_id).getRecordXML(record_xml);
 
-	HDF5Writer h5out(outputfile);
+	HDF5Writer& h5out = lalibeHDF5Writer(outputfile);
 	h5out.push(path);
 	std::string propagator_path = path+"/"+obj_name;
-	h5out.set_stripesize(1048576); // MAGIC NUMBER ALERT!  1048576 = 1024^2 = 1MB
-	h5out.write(propagator_path, obj, wmode);
+	h5out.set_stripesize(lalibeHDF5Tuning(outputfile).stripesize);
+	LalibeHDF5Precision<LatticeFermionF, LatticeFermion>::write(h5out, propagator_path, obj, wmode);
 	std::string record = record_xml.str();
 	std::string file = file_xml.str();
 	//This string needs to be broadcasted, right now only the head node has it.
@@ -843,8 +823,6 @@ namespace Chroma
 	h5out.writeAttribute(propagator_path, "record_xml_formatted", record_formatted, wmode);
 
 	h5out.cd("/");
-	h5out.close();
-
       }
 
 
@@ -854,18 +832,17 @@ namespace Chroma
 			   const std::string& obj_name,
 			   const std::string& path, HDF5Base::writemode wmode)
       {
-	LatticeFermionD obj;
 	XMLBufferWriter file_xml, record_xml;
 
-	obj = TheNamedObjMap::Instance().getData<LatticeFermion>(buffer_id);
+	const LatticeFermion& obj = TheNamedObjMap::Instance().getData<LatticeFermion>(buffer_id);
 	TheNamedObjMap::Instance().get(buffer_id).getFileXML(file_xml);
 	TheNamedObjMap::Instance().get(buffer_id).getRecordXML(record_xml);
 
-	HDF5Writer h5out(outputfile);
+	HDF5Writer& h5out = lalibeHDF5Writer(outputfile);
 	h5out.push(path);
 	std::string propagator_path = path+"/"+obj_name;
-	h5out.set_stripesize(1048576); // MAGIC NUMBER ALERT!  1048576 = 1024^2 = 1MB
-	h5out.write(propagator_path, obj, wmode);
+	h5out.set_stripesize(lalibeHDF5Tuning(outputfile).stripesize);
+	LalibeHDF5Precision<LatticeFermionD, LatticeFermion>::write(h5out, propagator_path, obj, wmode);
 	std::string record = record_xml.str();
 	std::string file = file_xml.str();
 	//This string needs to be broadcasted, right now only the head node has it.
@@ -897,8 +874,6 @@ namespace Chroma
 	h5out.writeAttribute(propagator_path, "record_xml_formatted", record_formatted, wmode);
 
 	h5out.cd("/");
-	h5out.close();
-
       }
 
       //! Write a staggered propagator
@@ -907,17 +882,16 @@ namespace Chroma
 			   const std::string& obj_name,
 			   const std::string& path, HDF5Base::writemode wmode)
       {
-	LatticeStaggeredPropagator obj;
 	XMLBufferWriter file_xml, record_xml;
 
-	obj = TheNamedObjMap::Instance().getData<LatticeStaggeredPropagator>(buffer_id);
+	const LatticeStaggeredPropagator& obj = TheNamedObjMap::Instance().getData<LatticeStaggeredPropagator>(buffer_id);
 	TheNamedObjMap::Instance().get(buffer_id).getFileXML(file_xml);
 	TheNamedObjMap::Instance().get(buffer_id).getRecordXML(record_xml);
 
-	HDF5Writer h5out(outputfile);
+	HDF5Writer& h5out = lalibeHDF5Writer(outputfile);
 	h5out.push(path);
 	std::string propagator_path = path+"/"+obj_name;
-	h5out.set_stripesize(1048576); // MAGIC NUMBER ALERT!  1048576 = 1024^2 = 1MB
+	h5out.set_stripesize(lalibeHDF5Tuning(outputfile).stripesize);
 	h5out.write(propagator_path, obj, wmode);
 	std::string record = record_xml.str();
 	std::string file = file_xml.str();
@@ -950,8 +924,6 @@ namespace Chroma
 	h5out.writeAttribute(propagator_path, "record_xml_formatted", record_formatted, wmode);
 
 	h5out.cd("/");
-	h5out.close();
-
       }
 
 
@@ -961,18 +933,17 @@ namespace Chroma
 			   const std::string& obj_name,
 			   const std::string& path, HDF5Base::writemode wmode)
       {
-	LatticeStaggeredPropagatorF obj;
 	XMLBufferWriter file_xml, record_xml;
 
-	obj = TheNamedObjMap::Instance().getData<LatticeStaggeredPropagator>(buffer_id);
+	const LatticeStaggeredPropagator& obj = TheNamedObjMap::Instance().getData<LatticeStaggeredPropagator>(buffer_id);
 	TheNamedObjMap::Instance().get(buffer_id).getFileXML(file_xml);
 	TheNamedObjMap::Instance().get(buffer_id).getRecordXML(record_xml);
 
-	HDF5Writer h5out(outputfile);
+	HDF5Writer& h5out = lalibeHDF5Writer(outputfile);
 	h5out.push(path);
 	std::string propagator_path = path+"/"+obj_name;
-	h5out.set_stripesize(1048576); // MAGIC NUMBER ALERT!  1048576 = 1024^2 = 1MB
-	h5out.write(propagator_path, obj, wmode);
+	h5out.set_stripesize(lalibeHDF5Tuning(outputfile).stripesize);
+	LalibeHDF5Precision<LatticeStaggeredPropagatorF, LatticeStaggeredPropagator>::write(h5out, propagator_path, obj, wmode);
 	std::string record = record_xml.str();
 	std::string file = file_xml.str();
 	//This string needs to be broadcasted, right now only the head node has it.
@@ -1004,7 +975,6 @@ namespace Chroma
 	h5out.writeAttribute(propagator_path, "record_xml_formatted", record_formatted, wmode);
 
 	h5out.cd("/");
-	h5out.close();
    
       }
 
@@ -1014,18 +984,17 @@ namespace Chroma
 			   const std::string& obj_name,
 			   const std::string& path, HDF5Base::writemode wmode)
       {
-	LatticeStaggeredPropagatorD obj;
 	XMLBufferWriter file_xml, record_xml;
 
-	obj = TheNamedObjMap::Instance().getData<LatticeStaggeredPropagator>(buffer_id);
+	const LatticeStaggeredPropagator& obj = TheNamedObjMap::Instance().getData<LatticeStaggeredPropagator>(buffer_id);
 	TheNamedObjMap::Instance().get(buffer_id).getFileXML(file_xml);
 	TheNamedObjMap::Instance().get(buffer_id).getRecordXML(record_xml);
 
-	HDF5Writer h5out(outputfile);
+	HDF5Writer& h5out = lalibeHDF5Writer(outputfile);
 	h5out.push(path);
 	std::string propagator_path = path+"/"+obj_name;
-	h5out.set_stripesize(1048576); // MAGIC NUMBER ALERT!  1048576 = 1024^2 = 1MB
-	h5out.write(propagator_path, obj, wmode);
+	h5out.set_stripesize(lalibeHDF5Tuning(outputfile).stripesize);
+	LalibeHDF5Precision<LatticeStaggeredPropagatorD, LatticeStaggeredPropagator>::write(h5out, propagator_path, obj, wmode);
 	std::string record = record_xml.str();
 	std::string file = file_xml.str();
 	//This string needs to be broadcasted, right now only the head node has it.
@@ -1057,7 +1026,6 @@ namespace Chroma
 	h5out.writeAttribute(propagator_path, "record_xml_formatted", record_formatted, wmode);
 
 	h5out.cd("/");
-	h5out.close();
    
       }
 
@@ -1068,17 +1036,16 @@ namespace Chroma
 			   const std::string& obj_name,
 			   const std::string& path, HDF5Base::writemode wmode)
       {
-	multi1d<LatticeColorMatrix> obj;
 	XMLBufferWriter file_xml, record_xml;
 
-	obj = TheNamedObjMap::Instance().getData< multi1d<LatticeColorMatrix> >(buffer_id);
+	const multi1d<LatticeColorMatrix>& obj = TheNamedObjMap::Instance().getData< multi1d<LatticeColorMatrix> >(buffer_id);
 	TheNamedObjMap::Instance().get(buffer_id).getFileXML(file_xml);
 	TheNamedObjMap::Instance().get(buffer_id).getRecordXML(record_xml);
 
-	HDF5Writer h5out(outputfile);
+	HDF5Writer& h5out = lalibeHDF5Writer(outputfile);
 	h5out.push(path);
 	std::string propagator_path = path+"/"+obj_name;
-	h5out.set_stripesize(1048576); // MAGIC NUMBER ALERT!  1048576 = 1024^2 = 1MB
+	h5out.set_stripesize(lalibeHDF5Tuning(outputfile).stripesize);
 	h5out.write(propagator_path, obj, wmode);
 	std::string record = record_xml.str();
 	std::string file = file_xml.str();
@@ -1111,7 +1078,6 @@ namespace Chroma
 	h5out.writeAttribute(propagator_path, "record_xml_formatted", record_formatted, wmode);
 
 	h5out.cd("/");
-	h5out.close();
     
       }
 
@@ -1133,10 +1099,10 @@ namespace Chroma
 	TheNamedObjMap::Instance().get(buffer_id).getFileXML(file_xml);
 	TheNamedObjMap::Instance().get(buffer_id).getRecordXML(record_xml);
 
-	HDF5Writer h5out(outputfile);
+	HDF5Writer& h5out = lalibeHDF5Writer(outputfile);
 	h5out.push(path);
 	std::string propagator_path = path+"/"+obj_name;
-	h5out.set_stripesize(1048576); // MAGIC NUMBER ALERT!  1048576 = 1024^2 = 1MB
+	h5out.set_stripesize(lalibeHDF5Tuning(outputfile).stripesize);
 	h5out.write(propagator_path, obj, wmode);
 	std::string record = record_xml.str();
 	std::string file = file_xml.str();
@@ -1169,7 +1135,6 @@ namespace Chroma
 	h5out.writeAttribute(propagator_path, "record_xml_formatted", record_formatted, wmode);
 
 	h5out.cd("/");
-	h5out.close();
     
       }
 
@@ -1190,10 +1155,10 @@ namespace Chroma
 	TheNamedObjMap::Instance().get(buffer_id).getFileXML(file_xml);
 	TheNamedObjMap::Instance().get(buffer_id).getRecordXML(record_xml);
 
-	HDF5Writer h5out(outputfile);
+	HDF5Writer& h5out = lalibeHDF5Writer(outputfile);
 	h5out.push(path);
 	std::string propagator_path = path+"/"+obj_name;
-	h5out.set_stripesize(1048576); // MAGIC NUMBER ALERT!  1048576 = 1024^2 = 1MB
+	h5out.set_stripesize(lalibeHDF5Tuning(outputfile).stripesize);
 	h5out.write(propagator_path, obj, wmode);
 	std::string record = record_xml.str();
 	std::string file = file_xml.str();
@@ -1226,7 +1191,6 @@ namespace Chroma
 	h5out.writeAttribute(propagator_path, "record_xml_formatted", record_formatted, wmode);
 
 	h5out.cd("/");
-	h5out.close();
     
       }
       //! Local registration flag
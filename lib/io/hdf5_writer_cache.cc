@@ -0,0 +1,68 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief HDF5 files kept open for the whole run, shared by every task writing to them
+ */
+
+//Protect everything with a preprocessing directive.
+#ifdef BUILD_HDF5
+
+#include "hdf5_writer_cache.h"
+#include "hdf5_output_queue.h"
+
+#include <map>
+
+namespace Chroma
+{
+  namespace
+  {
+    //! Every file opened so far in the run, by name
+    std::map<std::string, Handle<HDF5Writer>>& openWriters()
+    {
+      static std::map<std::string, Handle<HDF5Writer>> writers;
+      return writers;
+    }
+  }
+
+  HDF5Writer& lalibeHDF5Writer(const std::string& file_name)
+  {
+    std::map<std::string, Handle<HDF5Writer>>& writers = openWriters();
+    std::map<std::string, Handle<HDF5Writer>>::iterator it = writers.find(file_name);
+    if (it == writers.end())
+    {
+      QDPIO::cout << "Opening HDF5 file " << file_name << ", it stays open until flushed" << std::endl;
+      it = writers.insert(std::make_pair(file_name, Handle<HDF5Writer>(new HDF5Writer(file_name)))).first;
+    }
+    HDF5Writer& h5out = *(it->second);
+    h5out.cd("/");
+    return h5out;
+  }
+
+  void lalibeHDF5Close(const std::string& file_name)
+  {
+    // Staged writes to the file are done before it is closed
+    lalibeDrainHDF5Writes(file_name);
+
+    std::map<std::string, Handle<HDF5Writer>>& writers = openWriters();
+    std::map<std::string, Handle<HDF5Writer>>::iterator it = writers.find(file_name);
+    if (it == writers.end())
+      return;
+    QDPIO::cout << "Closing HDF5 file " << file_name << std::endl;
+    it->second->close();
+    writers.erase(it);
+  }
+
+  void lalibeHDF5CloseAll()
+  {
+    lalibeDrainHDF5Writes();
+
+    std::map<std::string, Handle<HDF5Writer>>& writers = openWriters();
+    for (std::map<std::string, Handle<HDF5Writer>>::iterator it = writers.begin(); it != writers.end(); ++it)
+    {
+      QDPIO::cout << "Closing HDF5 file " << it->first << std::endl;
+      it->second->close();
+    }
+    writers.clear();
+  }
+}
+
+#endif
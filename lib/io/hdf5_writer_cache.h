@@ -0,0 +1,35 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief HDF5 files kept open for the whole run, shared by every task writing to them
+ */
+
+//Protect everything with a preprocessing directive.
+#ifdef BUILD_HDF5
+
+#ifndef __hdf5_writer_cache_h__
+#define __hdf5_writer_cache_h__
+
+#include "chromabase.h"
+
+#include <string>
+
+namespace Chroma
+{
+  //! The open writer for file_name
+  /*!
+   * The file is opened the first time any task asks for it and then stays open, so a run that
+   * writes many correlators or objects to one file only opens it once. The writer is handed back
+   * at the root group. Tasks must not close it, lalibeHDF5Close does that.
+   */
+  HDF5Writer& lalibeHDF5Writer(const std::string& file_name);
+
+  //! Do the staged writes to file_name and close it if it is open, everything written to it is then on disk
+  void lalibeHDF5Close(const std::string& file_name);
+
+  //! Do every staged write and close every open file, done at the end of the run and by HDF5_FLUSH
+  void lalibeHDF5CloseAll();
+}
+
+#endif
+
+#endif
@@ -8,9 +8,59 @@
 //This is needed for the chromomag operator.
 #include "chromomag_seqsource_w.h"
 
+#include <map>
+
 
 namespace Chroma 
 { 
+  namespace
+  {
+    //! Gamma matrix index and sign of each local bilinear, false for unknown ones (and CHROMO_MAG)
+    bool bilinear_gamma_index(const std::string& present_current, int& gamma, bool& negate)
+    {
+      static const std::map<std::string, std::pair<int, bool>> gamma_map = {
+	{ "S",   { 0,  false } },
+	{ "P",   { 15, false } },
+	{ "A1",  { 14, false } },
+	{ "A2",  { 13, true  } },
+	{ "A3",  { 11, false } },
+	{ "A4",  { 7,  true  } },
+	{ "V1",  { 1,  false } },
+	{ "V2",  { 2,  false } },
+	{ "V3",  { 4,  false } },
+	{ "V4",  { 8,  false } },
+	{ "T12", { 3,  false } },
+	{ "T13", { 5,  false } },
+	{ "T14", { 9,  false } },
+	{ "T23", { 6,  false } },
+	{ "T24", { 10, false } },
+	{ "T34", { 12, false } },
+      };
+      auto gIt = gamma_map.find(present_current);
+      if (gIt == gamma_map.end())
+	return false;
+      gamma = gIt->second.first;
+      negate = gIt->second.second;
+      return true;
+    }
+
+    template<typename P>
+    void bilinear_gamma_local(const std::string& present_current, P& out_quark_src, const P& quark_src, const Subset& sub)
+    {
+      int gamma;
+      bool negate;
+      if (!bilinear_gamma_index(present_current, gamma, negate))
+      {
+	QDPIO::cerr << present_current << ": NOT DEFINED YET " << std::endl;
+	QDP_abort(1);
+      }
+      if (negate)
+	out_quark_src[sub] = Gamma(gamma) * -quark_src;
+      else
+	out_quark_src[sub] = Gamma(gamma) * quark_src;
+    }
+  }
+
   //! Construct the "bilinear"
   /*!
    * \ingroup bilinear
@@ -18,48 +68,28 @@ namespace Chroma
    * Arguments:
    *  \param b		 (bilinear ID)
    */
-  void Bilinear_Gamma(std::string present_current, LatticePropagator& out_quark_src, LatticePropagator& quark_src, const multi1d<LatticeColorMatrix>& u){
+  void Bilinear_Gamma(std::string present_current, LatticePropagator& out_quark_src, const LatticePropagator& quark_src, const multi1d<LatticeColorMatrix>& u, const Subset& sub){
     START_CODE();
-	if (present_current == "S")
-	   out_quark_src =  Gamma(0)* quark_src;
-    else if (present_current == "P")
-       out_quark_src =  Gamma(15)* quark_src;
-    else if (present_current == "A1")
-       out_quark_src =  Gamma(14)* quark_src;
-    else if (present_current == "A2")
-       out_quark_src =  Gamma(13)* -quark_src;
-    else if (present_current == "A3")
-       out_quark_src =  Gamma(11)* quark_src;
-    else if (present_current == "A4")
-       out_quark_src =  Gamma(7)* -quark_src;
-    else if (present_current == "V1")
-       out_quark_src =  Gamma(1)* quark_src;
-    else if (present_current == "V2")
-       out_quark_src =  Gamma(2)* quark_src;
-    else if (present_current == "V3")
-       out_quark_src =  Gamma(4)* quark_src;
-    else if (present_current == "V4")
-       out_quark_src =  Gamma(8)* quark_src;
-    else if (present_current == "T12")
-       out_quark_src =  Gamma(3)* quark_src;
-    else if (present_current == "T13")
-       out_quark_src =  Gamma(5)* quark_src;
-    else if (present_current == "T14")
-       out_quark_src =  Gamma(9)* quark_src;
-    else if (present_current == "T23")
-       out_quark_src =  Gamma(6)* quark_src;
-    else if (present_current == "T24")
-       out_quark_src =  Gamma(10)* quark_src;
-    else if (present_current == "T34")
-       out_quark_src =  Gamma(12)* quark_src;
-    else if (present_current == "CHROMO_MAG")
-	  out_quark_src =  chromoMagneticSeqSource(quark_src,u);
+    if (present_current == "CHROMO_MAG")
+      out_quark_src = chromoMagneticSeqSource(quark_src,u);
     else
+      bilinear_gamma_local(present_current, out_quark_src, quark_src, sub);
+    END_CODE();
+  }
+
+#if BASE_PRECISION==64
+  void Bilinear_Gamma(std::string present_current, LatticePropagatorF& out_quark_src, const LatticePropagatorF& quark_src, const multi1d<LatticeColorMatrix>& u, const Subset& sub){
+    START_CODE();
+    if (present_current == "CHROMO_MAG")
     {
-		QDPIO::cerr << present_current << ": NOT DEFINED YET " << std::endl;
-    	QDP_abort(1);
+      //The chromo-magnetic operator needs the gauge field, it is applied in double precision.
+      LatticePropagator quark_src_d = quark_src;
+      out_quark_src = chromoMagneticSeqSource(quark_src_d,u);
     }
+    else
+      bilinear_gamma_local(present_current, out_quark_src, quark_src, sub);
     END_CODE();
   }
+#endif
 
 } // ENd namespace Chroma
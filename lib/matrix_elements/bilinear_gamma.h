@@ -15,9 +15,15 @@ namespace Chroma
    *
    * Arguments:
    *  \param b		 (bilinear ID)
+   *  \param sub		 (sites the gamma insertions are applied on, CHROMO_MAG is always computed everywhere)
    */
 
-  void Bilinear_Gamma(std::string present_current, LatticePropagator& out_quark_src, LatticePropagator& quark_src, const multi1d<LatticeColorMatrix>& u);
+  void Bilinear_Gamma(std::string present_current, LatticePropagator& out_quark_src, const LatticePropagator& quark_src, const multi1d<LatticeColorMatrix>& u, const Subset& sub = all);
+
+#if BASE_PRECISION==64
+  //! Same on single precision propagators, for the mixed precision contractions
+  void Bilinear_Gamma(std::string present_current, LatticePropagatorF& out_quark_src, const LatticePropagatorF& quark_src, const multi1d<LatticeColorMatrix>& u, const Subset& sub = all);
+#endif
 }
 
 #endif
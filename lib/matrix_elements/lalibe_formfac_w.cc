@@ -11,6 +11,9 @@
 #include "lalibe_formfac_w.h"
 #include "bilinear_gamma.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace Chroma
 {
 
@@ -152,7 +155,8 @@ namespace Chroma
 	       HDF5Writer & h5writer,
 	       HDF5Base::writemode & h5mode,
 #endif
-	       int t0)
+	       int t0,
+	       LalibeContractionPrecision precision)
   {
     START_CODE();
 
@@ -161,16 +165,31 @@ namespace Chroma
 
     int G5 = Ns*Ns-1;
 
-    // Construct the anti-quark propagator from the seq. quark prop.
-
+    // With a time window on the phases only the window is contracted, the currents are zero elsewhere.
+    const Subset& window = phases.getWindow();
 
-    LatticePropagator anti_quark_prop = Gamma(G5) * seq_quark_prop * Gamma(G5);
-    /*
-        NOTE: The following '-' sign is added to account for another '-' we are
-        not sure where it comes from - but checking against known results, we
-        know we are off by an overall sign, so we add it here
-    */
-    anti_quark_prop = -anti_quark_prop;
+    // Construct the anti-quark propagator from the seq. quark prop.
+    // It is only made in the precision that is contracted, in single precision the double one
+    // is only built if a nonlocal current needs it.
+    //Sites outside the window are zeroed, the nonlocal current shifts across the window edge.
+    Handle<LatticePropagator> anti_quark_prop;
+    bool have_anti_quark_prop = false;
+    auto make_anti_quark_prop = [&]()
+    {
+      anti_quark_prop = Handle<LatticePropagator>(new LatticePropagator);
+      have_anti_quark_prop = true;
+      if(phases.hasWindow())
+	*anti_quark_prop = zero;
+      (*anti_quark_prop)[window] = Gamma(G5) * seq_quark_prop * Gamma(G5);
+      /*
+	  NOTE: The following '-' sign is added to account for another '-' we are
+	  not sure where it comes from - but checking against known results, we
+	  know we are off by an overall sign, so we add it here
+      */
+      (*anti_quark_prop)[window] = -(*anti_quark_prop);
+    };
+    if(precision != CONTRACT_SINGLE)
+      make_anti_quark_prop();
 
     // Rough timings (arbitrary units):
     //   Variant 1: 120
@@ -187,12 +206,38 @@ namespace Chroma
 
     int gamma_value = 0;
 
-    //These are needed in the loop, but never change.
-    LatticePropagator gamma_propagator = zero;
-    LatticePropagator quark = quark_propagator;
-
     multi1d<LatticeColorMatrix> gfield = u;
 
+    //The local currents of all insertions are kept and momentum projected together after the loop,
+    //so the phases are traversed once for the whole current list instead of once per current.
+    //Only the precision that is projected is kept, both for validate.
+    multi1d<LatticeComplex> local_currents;
+    if(full_correlator == false && precision != CONTRACT_SINGLE)
+      local_currents.resize(bilinears.size());
+    multi1d<bool> nonlocal_computed(bilinears.size());
+
+#if BASE_PRECISION==64
+    //Mixed precision: the local currents are contracted from single precision copies of the propagators,
+    //the momentum projection below still sums in double. The copies are only allocated when they are used,
+    //and the anti-quark one is rounded straight from the seq. quark prop.
+    Handle<LatticePropagatorF> quark_f, anti_quark_prop_f;
+    multi1d<LatticeComplexF> local_currents_f;
+    if(precision != CONTRACT_DOUBLE)
+    {
+      quark_f = Handle<LatticePropagatorF>(new LatticePropagatorF);
+      anti_quark_prop_f = Handle<LatticePropagatorF>(new LatticePropagatorF);
+      *quark_f = quark_propagator;
+      if(phases.hasWindow())
+	*anti_quark_prop_f = zero;
+      (*anti_quark_prop_f)[window] = seq_quark_prop;
+      (*anti_quark_prop_f)[window] = Gamma(G5) * (*anti_quark_prop_f) * Gamma(G5);
+      //Same overall sign as the double precision one above.
+      (*anti_quark_prop_f)[window] = -(*anti_quark_prop_f);
+      local_currents_f.resize(bilinears.size());
+    }
+#endif
+    multi1d<multi2d<DComplex>> hsums_nonlocal(bilinears.size());
+
     for(int current_index = 0; current_index < bilinears.size(); current_index++)
     {
       //  For the case where the gamma value indicates we are evaluating either
@@ -239,11 +284,30 @@ namespace Chroma
 
       // The local non-conserved std::vector-current matrix element
       //Use lalibe functions for gamma insertions.
-      Bilinear_Gamma(present_current, gamma_propagator, quark, u);
+      LatticeComplex local_current;
+      if(phases.hasWindow())
+	local_current = zero;
 
-      LatticeComplex local_current = trace(adj(anti_quark_prop) * gamma_propagator * Gamma(gamma_insertion));
+#if BASE_PRECISION==64
+      if(precision != CONTRACT_DOUBLE)
+      {
+	LatticePropagatorF gamma_propagator_f;
+	Bilinear_Gamma(present_current, gamma_propagator_f, *quark_f, u, window);
+	if(phases.hasWindow())
+	  local_currents_f[current_index] = zero;
+	local_currents_f[current_index][window] = trace(adj(*anti_quark_prop_f) * gamma_propagator_f * Gamma(gamma_insertion));
+	if(precision == CONTRACT_SINGLE && full_correlator == true)
+	  local_current = local_currents_f[current_index];
+      }
+      if(precision != CONTRACT_SINGLE)
+#endif
+      {
+	LatticePropagator gamma_propagator;
+	Bilinear_Gamma(present_current, gamma_propagator, quark_propagator, u, window);
+	local_current[window] = trace(adj(*anti_quark_prop) * gamma_propagator * Gamma(gamma_insertion));
+      }
 
-       multi2d<DComplex> hsum, hsum_nonlocal;
+      nonlocal_computed[current_index] = compute_nonlocal;
 
       //We only do momentum injection if we are not dumping out the full, 4-d correlator.
       if(full_correlator == true)
@@ -257,8 +321,8 @@ namespace Chroma
 	h5writer.cd("/");
 #endif
       }
-      else
-	hsum = phases.sft(local_current);
+      else if(precision != CONTRACT_SINGLE)
+	local_currents[current_index] = local_current;
 
 
       // Construct the non-local current matrix element
@@ -270,7 +334,11 @@ namespace Chroma
 
 
       if(compute_nonlocal){
-	Bilinear_Gamma(present_current, gamma_propagator, quark, u);
+	if(!have_anti_quark_prop)
+	  make_anti_quark_prop();
+	const LatticePropagator& anti_quark_prop_d = *anti_quark_prop;
+	LatticePropagator gamma_propagator;
+	Bilinear_Gamma(present_current, gamma_propagator, quark_propagator, u);
 /*
         LatticePropagator tmp_prop1 = adj(gfield[mu])*(quark_propagator + gamma_propagator);
         LatticePropagator tmp_prop2 = shift(seq_prop,FORWARD,mu);
@@ -284,12 +352,12 @@ namespace Chroma
         tmp_prop1 = gfield[mu]*tmp_prop1;
         non_local_current -= 0.5*SpinColorArraySum(tmp_prop1,seq_prop);
 */
-	non_local_current = trace(adj(u[mu] * shift(anti_quark_prop, FORWARD, mu)) *
+	non_local_current = trace(adj(u[mu] * shift(anti_quark_prop_d, FORWARD, mu)) *
 		(quark_propagator + gamma_propagator) * Gamma(gamma_insertion));
 	LatticePropagator tmp_prop1 = u[mu] *
 	  shift(quark_propagator, FORWARD, mu);
 	Bilinear_Gamma(present_current, gamma_propagator, tmp_prop1, u);
-	non_local_current -= trace(adj(anti_quark_prop) *
+	non_local_current -= trace(adj(anti_quark_prop_d) *
 				  (tmp_prop1 - gamma_propagator) * Gamma(gamma_insertion));
 
         non_local_current = 0.5*non_local_current;
@@ -306,13 +374,46 @@ namespace Chroma
 #endif
 	}
 	else
-	  hsum_nonlocal = phases.sft(non_local_current);
+	  hsums_nonlocal[current_index] = phases.sft(non_local_current);
       }
+    }
+
+
+    if(full_correlator == false)
+    {
+      multi1d<multi2d<DComplex>> hsums;
+#if BASE_PRECISION==64
+      if(precision != CONTRACT_DOUBLE)
+      {
+	std::vector<const LatticeComplexF*> currents_f;
+	for(int current_index = 0; current_index < bilinears.size(); current_index++)
+	  currents_f.push_back(&local_currents_f[current_index]);
+	multi1d<multi2d<DComplex>> hsums_f = phases.sft(currents_f);
 
+	if(precision == CONTRACT_VALIDATE)
+	{
+	  hsums = phases.sft(local_currents);
+	  double max_dev = 0.0;
+	  for(int current_index = 0; current_index < bilinears.size(); current_index++)
+	    max_dev = std::max(max_dev, maxRelativeDeviation(hsums[current_index], hsums_f[current_index]));
+	  QDPIO::cout << "LALIBE_FORM_FACTOR: max relative deviation of single from double precision currents = "
+		      << max_dev << std::endl;
+	}
+	else
+	  hsums = hsums_f;
+      }
+      else
+#endif
+	hsums = phases.sft(local_currents);
 
-      form.formFac[gamma_value].gamma_value = gamma_value;
-      if(full_correlator == false)
+      for(int current_index = 0; current_index < bilinears.size(); current_index++)
       {
+	std::string present_current = bilinears[current_index];
+	bool compute_nonlocal = nonlocal_computed[current_index];
+	const multi2d<DComplex>& hsum = hsums[current_index];
+	const multi2d<DComplex>& hsum_nonlocal = hsums_nonlocal[current_index];
+
+	form.formFac[gamma_value].gamma_value = gamma_value;
 	form.formFac[gamma_value].momenta.resize(phases.numMom());  // hold momenta output
 
 	// Loop over insertion momenta and print out results
@@ -364,7 +465,7 @@ namespace Chroma
 
 	} // end for(inser_mom_num)
 	gamma_value++;
-      } // end for(gamma_value)
+      } // end for(current_index)
     }// end if stattement to do mom
     END_CODE();
   }
@@ -7,6 +7,7 @@
 #define __lalibe_formfac_h__
 
 #include "../momentum/lalibe_sftmom.h"
+#include "../contractions/contraction_precision.h"
 
 namespace Chroma 
 {
@@ -80,6 +81,7 @@ namespace Chroma
    * \param gamma_insertion    extra gamma insertion at source ( Read )
    * \param phases             fourier transform phase factors ( Read )
    * \param t0                 cartesian coordinates of the source ( Read )
+   * \param precision          contract the local currents in double, single or both and compare ( Read )
    */
 
   void FormFac(LalibeFormFac_insertions_t& form,
@@ -97,7 +99,8 @@ namespace Chroma
 	       HDF5Writer & h5writer,
 	       HDF5Base::writemode & h5mode,
 #endif
-	       int t0);
+	       int t0,
+	       LalibeContractionPrecision precision = CONTRACT_DOUBLE);
 
 }  // end namespace Chroma
 
@@ -0,0 +1,68 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Noise outer products for the stochastic FH propagators
+ */
+
+#include "chromabase.h"
+#include "stochastic_outer_product_w.h"
+#include "bilinear_gamma.h"
+
+namespace Chroma 
+{ 
+  Propagator noise_overlap(const LatticeComplex& noise,
+			   const LatticePropagator& fh_prop_src)
+  {
+    //Element (s c, s' c') is innerProduct(noise diluted onto spin s and color c, column s' c' of fh_prop_src),
+    //all 144 of them in one sweep and one global sum.
+    Propagator overlap = sum(conj(noise) * fh_prop_src);
+    return overlap;
+  }
+
+  void noise_outer_product(const LatticePropagator& noise_prop,
+			   const LatticeComplex& noise,
+			   const LatticePropagator& fh_prop_src,
+			   LatticePropagator& stochastic_fh_prop)
+  {
+    START_CODE();
+    Propagator overlap = noise_overlap(noise, fh_prop_src);
+    stochastic_fh_prop = noise_prop * overlap;
+    END_CODE();
+  }
+
+  int fh_source_block_size(int num_sources, int source_cache_size)
+  {
+    if (source_cache_size > 0 && source_cache_size < num_sources)
+      return source_cache_size;
+    return num_sources;
+  }
+
+  void phased_fh_sources(const multi1d<std::string>& currents,
+			 const LatticePropagator& quark_propagator,
+			 const multi1d<LatticeColorMatrix>& u,
+			 const LalibeSftMom& ft,
+			 int block_start, int block_end,
+			 multi1d<LatticePropagator>& phased_srcs)
+  {
+    START_CODE();
+    //The current is only inserted again when the block moves on to the next one.
+    LatticePropagator fh_prop_src;
+    int last_current = -1;
+    for(int source_index = block_start; source_index < block_end; source_index++)
+    {
+      int current_index = source_index / ft.numMom();
+      int mom = source_index % ft.numMom();
+      if (current_index != last_current)
+      {
+	QDPIO::cout << "FH source: current " << currents[current_index] << std::endl;
+	// WE SHOULD MAKE THIS A FACTORY
+	Bilinear_Gamma(currents[current_index], fh_prop_src, quark_propagator, u);
+	last_current = current_index;
+      }
+      multi1d<int> momenta = ft.numToMom(mom);
+      QDPIO::cout << "Injecting momentum - px: "<<std::to_string(momenta[0])<<" py: "+std::to_string(momenta[1])<<" pz: "+std::to_string(momenta[2])<<std::endl;
+      //Each momentum phases the unphased current-inserted source.
+      phased_srcs[source_index - block_start] = ft[mom]*fh_prop_src;
+    }
+    END_CODE();
+  }
+}
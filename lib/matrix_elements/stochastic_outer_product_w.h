@@ -0,0 +1,71 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Noise outer products for the stochastic FH propagators
+ */
+
+#ifndef __stochastic_outer_product_w_h__
+#define __stochastic_outer_product_w_h__
+
+#include "chromabase.h"
+#include "../momentum/lalibe_sftmom.h"
+
+namespace Chroma 
+{ 
+  //! Tie a noise propagator to a FH source through its noise vector
+  /*!
+   * \ingroup matrix_elements
+   *
+   * Computes, for every spin-color column of fh_prop_src,
+   *   stochastic_fh_prop = noise_prop * sum_x conj(noise(x)) fh_prop_src(x)
+   * which is what diluting the noise over all 12 spin-color components and taking the
+   * innerProduct of each diluted source with each column of fh_prop_src gives.
+   * The 12x12 overlap matrix comes out of a single global reduction and the product with
+   * the noise propagator is one site-local propagator times spin-color matrix multiply.
+   *
+   * Arguments:
+   *  \param noise_prop          propagator solved on the diluted noise ( Read )
+   *  \param noise               the scalar noise the sources were diluted from ( Read )
+   *  \param fh_prop_src         current inserted FH source ( Read )
+   *  \param stochastic_fh_prop  the outer product ( Write )
+   */
+  void noise_outer_product(const LatticePropagator& noise_prop,
+			   const LatticeComplex& noise,
+			   const LatticePropagator& fh_prop_src,
+			   LatticePropagator& stochastic_fh_prop);
+
+  //! The noise overlap matrix alone, sum_x conj(noise(x)) fh_prop_src(x)
+  Propagator noise_overlap(const LatticeComplex& noise,
+			   const LatticePropagator& fh_prop_src);
+
+  //! Number of current-inserted, momentum-phased FH sources held at once
+  /*!
+   * All num_sources of them, unless source_cache_size is positive and smaller.
+   */
+  int fh_source_block_size(int num_sources, int source_cache_size);
+
+  //! Build a block of current-inserted, momentum-phased FH sources
+  /*!
+   * \ingroup matrix_elements
+   *
+   * The source index runs over currents and momenta, momenta inner most, the same ordering
+   * as the fh_prop_id lists. The sources do not depend on the noise, so the stochastic FH
+   * tasks build them once per block and reuse them for every noise vector.
+   *
+   * Arguments:
+   *  \param currents          the currents inserted ( Read )
+   *  \param quark_propagator  the propagator the currents are inserted on ( Read )
+   *  \param u                 gauge field ( Read )
+   *  \param ft                momenta the sources are phased with ( Read )
+   *  \param block_start       first source index of the block ( Read )
+   *  \param block_end         one past the last source index of the block ( Read )
+   *  \param phased_srcs       phased_srcs[i] is source block_start + i ( Modify )
+   */
+  void phased_fh_sources(const multi1d<std::string>& currents,
+			 const LatticePropagator& quark_propagator,
+			 const multi1d<LatticeColorMatrix>& u,
+			 const LalibeSftMom& ft,
+			 int block_start, int block_end,
+			 multi1d<LatticePropagator>& phased_srcs);
+}
+
+#endif
@@ -23,11 +23,13 @@ OUTPUT
 #include "util/info/unique_id.h"
 //We need this to insert Fermions to a Prop, this is imperitive for dilution.
 #include "util/ferm/transf.h"
+#include <algorithm>
 
 // Lalibe Stuff
 #include "HP_fh_prop_w.h"
 #include "../matrix_elements/bilinear_gamma.h"
-#include "../numerics/binaryRecursiveColoring_v2.h"
+#include "../matrix_elements/stochastic_outer_product_w.h"
+#include "../numerics/noise_source_w.h"
 //#include "../numerics/binaryRecursiveColoring.h"
 
 namespace Chroma
@@ -107,6 +109,13 @@ namespace Chroma
 		par.delete_props = false;
 		QDPIO::cout<<"By default, no props will be deleted after sum "<<std::endl;
 	    }
+	    if (paramtop.count("source_cache_size") != 0)
+	    {
+		read(paramtop, "source_cache_size", par.source_cache_size);
+		QDPIO::cout<<"At most "<<par.source_cache_size<<" current-inserted sources will be cached at a time "<<std::endl;
+	    }
+	    else
+		par.source_cache_size = 0;
         }
 
         void write(XMLWriter& xml, const std::string& path, HPFHParams::HPFHProp_t& par)
@@ -123,6 +132,7 @@ namespace Chroma
 	    else
 	      write(xml, "mom_list" ,par.mom_list);
 	    write(xml, "delete_props" ,par.delete_props);
+	    write(xml, "source_cache_size" ,par.source_cache_size);
             pop(xml);
 
         }
@@ -279,111 +289,13 @@ namespace Chroma
               : LalibeSftMom(params.hpfhparam.p_list, origin, j_decay);
 	    // Make an action and all other stuff needed for a solver.
 
-	    LatticePropagator fh_prop_src = quark_propagator;
 	    LatticePropagator hp_src = zero;
 	    LatticePropagator hp_fh_prop = zero;
 
 	    //Here's where the actual noisy stuff happens.
-	    LatticeComplex noise_vec ;
-	    Seed ran_seed;
-	    QDP::RNG::savern(ran_seed);
-
-	    // Set the seed to desired value
-	    QDP::RNG::setrn(params.hpfhparam.ran_seed);
-
-	    int ZN  = params.hpfhparam.ZN;
-	    LatticeReal rnd1, theta;
-	    // twopi defined in chroma/lib/chromabase.h
-	    Real twopiN = Chroma::twopi / ZN;
-	    random(rnd1);
-	    theta = twopiN * floor(ZN*rnd1);
-	    noise_vec = cmplx(cos(theta),sin(theta));
-
-	    //restore the seed
-	    QDP::RNG::setrn(ran_seed);
-
-	    //Here is where the HP stuff is created; adopted from Andrea's main function.
-	    struct meshVars mesh;
-	    unsigned int i, N, Hpsize, sample;
-	    unsigned int *perm, *Hperm;
-	    //double *RHS;
-
-	    mesh.d = Nd;
-	    mesh.ptsPerDim = (unsigned int *)malloc(sizeof(unsigned int)*mesh.d);
-	    N=1;
-	    for (i=0;i<mesh.d; i++){
-	      //printf("dim(%u): ",i);
-	      //scanf("%u", &mesh.ptsPerDim[i]);
-	      //This logic is taken from Bit Twiddling Hacks by Sean Anderson, September 5, 2010
-	      unsigned int v = Layout::lattSize()[i]; // compute the next highest power of 2 of 32-bit v
-	      v--;
-	      v |= v >> 1;
-	      v |= v >> 2;
-	      v |= v >> 4;
-	      v |= v >> 8;
-	      v |= v >> 16;
-	      v++;
-	      //mesh.ptsPerDim[i] = Layout::lattSize()[i];
-	      //Extend HP to beyond purely powers of two.
-	      mesh.ptsPerDim[i] = v;
-	      N *= mesh.ptsPerDim[i];
-	    }
-
-	    /* Set up the hierarchical data structs */
-	    hierOrderSetUp(&mesh);
-
-	    /* Find the row permutation once for each point in local mesh*/
-	    /* Here it's done for all nodes N. But can be done only for local ones */
-	    perm = (unsigned int *)malloc(sizeof(unsigned int)*N);
-	    hierPerm(&mesh, perm, N);
-
-	    /* Now with the perm obtained we do not need the mesh any more */
-	    freeMeshVars(&mesh);
-
-	    /* Create the column permutation of the Hadamard vectors. Do it once */
-	    /* Create only for as many columns as you need. For example 1024 or 4096 */
-	    /* CAUTION: N is the global size (total spatial dimension of the mesh) */
-	    /* CAUTION: N must be a power of 2 */
-	    //Hpsize = 1024;
-	    Hpsize = params.hpfhparam.ending_vector;
-	    Hperm = (unsigned int *)malloc(sizeof(unsigned int)*Hpsize);
-	    hadaColPerm(N, Hperm, Hpsize);
-	    /**********************************************************************/
-	    /* At this point we are ready to create the permuted Hadamard vectors */
-	    /* What is needed is perm and Hperm */
-	    /**********************************************************************/
-
-	    //Object to hold HP vectors we want to invert
-	    multi1d <LatticeInteger> vectors;
-	    vectors.resize(params.hpfhparam.ending_vector - params.hpfhparam.starting_vector + 1);
-
-	    //Back to code adopted from Andrea's main function.
-	    //for (sample=0; sample<Hpsize; sample++) {
-	       ///* I create all N here, but it can be done on local rows only */
-	       //for (i=0;i<N;i++)
-		  //RHS[i] = (double) Hada_element(perm[i], Hperm[sample]);
-
-	       ///* use RHS in trace computation */
-	    //}
-
-	    int Nx = Layout::lattSize()[0];
-	    int Ny = Layout::lattSize()[1];
-	    int Nz = Layout::lattSize()[2];
-	    int Nt = Layout::lattSize()[3];
-	    for(int HP_index = params.hpfhparam.starting_vector; HP_index < params.hpfhparam.ending_vector + 1; HP_index++)
-	      for(int x = 0; x < Nx; x++)
-		for(int y = 0; y < Ny; y++)
-		  for(int z = 0; z < Nz; z++)
-		    for(int t = 0; t < Nt; t++)
-		    {
-		      multi1d<int> chroma_coords;
-		      chroma_coords.resize(Nd);
-		      chroma_coords[0] = x; chroma_coords[1] = y; chroma_coords[2] = z; chroma_coords[3] = t;
-		      int i = Layout::linearSiteIndex(chroma_coords);
-		      int element = Hada_element(perm[i], (Hperm[HP_index - 1]));
-		      Integer chroma_element = element;
-		      pokeSite(vectors[HP_index - params.hpfhparam.starting_vector], chroma_element, chroma_coords);
-		    }
+	    //Each probing vector is made when it is needed, from the seed and its vector number.
+	    HPNoiseSource probes(params.hpfhparam.ran_seed, params.hpfhparam.ZN, params.hpfhparam.ending_vector);
+	    const int num_vecs = params.hpfhparam.ending_vector - params.hpfhparam.starting_vector + 1;
 
 	    //This is the old way of doing the noise bit.
 	    //Now let's do some dilution and turn this noise into a proper quark!
@@ -412,92 +324,86 @@ namespace Chroma
 	    for(int accumulation_index = 0; accumulation_index < accumulated_props.size(); accumulation_index++)
 	      accumulated_props[accumulation_index] = zero;
 
+	    //The current-inserted, momentum-phased sources do not depend on the probing vector, so they are built
+	    //once and reused for every vector. At most source_cache_size of them are held at a time; if there are
+	    //more (current, mom) pairs than that, they are done in blocks and the hp props are revisited per block.
+	    const int num_sources = params.hpfhparam.currents.size()*ft.numMom();
+	    int cache_size = fh_source_block_size(num_sources, params.hpfhparam.source_cache_size);
+	    multi1d <LatticePropagator> phased_srcs;
+	    phased_srcs.resize(cache_size);
+	    QDPIO::cout << "HP_FH_PROPAGATOR: caching " << cache_size << " of " << num_sources
+		<< " current-inserted sources at a time" << std::endl;
+
 	    ComplexD Trace = 0.0;
-	    //Noise loop
-	    for(int vec_index = 0; vec_index < vectors.size(); vec_index++)
+	    for(int block_start = 0; block_start < num_sources; block_start += cache_size)
 	    {
-              // Read "hp" quark propagator, now this is done inside a loop over hp vectors
-	      XMLReader hp_prop_file_xml, hp_prop_record_xml;
-	      LatticePropagator hp_quark_propagator;
-	      QDPIO::cout << "Attempt to read HP propagator number " << vec_index << std::endl;
-	      try
-	      {
-		  hp_quark_propagator = TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.hp_prop_id[vec_index]);
-		  TheNamedObjMap::Instance().get(params.named_obj.hp_prop_id[vec_index]).getFileXML(hp_prop_file_xml);
-		  TheNamedObjMap::Instance().get(params.named_obj.hp_prop_id[vec_index]).getRecordXML(hp_prop_record_xml);
-	      }
-              catch (std::bad_cast)
-	      {
-		  QDPIO::cerr << name << ": caught dynamic cast error" << std::endl;
-		  QDP_abort(1);
-	      }
-	      catch (const std::string& e)
-	      {
-		  QDPIO::cerr << name << ": error reading hp prop_header: "
-		      << e << std::endl;
-		  QDP_abort(1);
-	      }
-	      for(int current_index = 0; current_index < params.hpfhparam.currents.size(); current_index++)
+	      const int block_end = std::min(block_start + cache_size, num_sources);
+	      phased_fh_sources(params.hpfhparam.currents, quark_propagator, u, ft, block_start, block_end, phased_srcs);
+	      const bool first_block = (block_start == 0);
+	      const bool last_block = (block_end == num_sources);
+
+	      //Noise loop
+	      for(int vec_index = 0; vec_index < num_vecs; vec_index++)
 	      {
-		std::string present_current = params.hpfhparam.currents[current_index];
-		QDPIO::cout << "HP_FH_PROPAGATOR: current " << present_current << std::endl;
-		// WE SHOULD MAKE THIS A FACTORY
-		Bilinear_Gamma(present_current, fh_prop_src, quark_propagator, u);
-		for(int mom = 0; mom < ft.numMom(); mom++)
+		// Read "hp" quark propagator, now this is done inside a loop over hp vectors
+		XMLReader hp_prop_file_xml, hp_prop_record_xml;
+		QDPIO::cout << "Attempt to read HP propagator number " << vec_index << std::endl;
+		const LatticePropagator* hp_ptr = 0;
+		try
+		{
+		    //Work straight off the stored object, no copy is needed.
+		    hp_ptr = &TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.hp_prop_id[vec_index]);
+		    TheNamedObjMap::Instance().get(params.named_obj.hp_prop_id[vec_index]).getFileXML(hp_prop_file_xml);
+		    TheNamedObjMap::Instance().get(params.named_obj.hp_prop_id[vec_index]).getRecordXML(hp_prop_record_xml);
+		}
+		catch (std::bad_cast)
+		{
+		    QDPIO::cerr << name << ": caught dynamic cast error" << std::endl;
+		    QDP_abort(1);
+		}
+		catch (const std::string& e)
+		{
+		    QDPIO::cerr << name << ": error reading hp prop_header: "
+			<< e << std::endl;
+		    QDP_abort(1);
+		}
+		const LatticePropagator& hp_quark_propagator = *hp_ptr;
+		LatticeComplex HP_vec;
+		probes(params.hpfhparam.starting_vector + vec_index, HP_vec);
+		//Sum over the diluted sources of innerProduct(hp_ferm, chi), i.e. the hp prop traced against its source.
+		//Only computed once per vector, on the first block.
+		if (first_block)
+		{
+		  Trace += sum(HP_vec*conj(trace(hp_quark_propagator)));
+		  //Print debugger
+		  QDPIO::cout<<"HP Trace "<<vec_index+1<<" - "<<(Trace/(vec_index+1))<<std::endl;
+		}
+		for(int source_index = block_start; source_index < block_end; source_index++)
 		{
-
-		  multi1d<int> momenta = ft.numToMom(mom);
-		  QDPIO::cout << "Injecting momentum - px: "<<std::to_string(momenta[0])<<" py: "+std::to_string(momenta[1])<<" pz: "+std::to_string(momenta[2])<<std::endl;
-		  fh_prop_src = ft[mom]*fh_prop_src;
 		  //Below is the thing that matters.
 		  //The hp_prop is tied with the source_prop and hp_src to make the hp FH prop.
 		  //hp_fh_prop = hp_quark_propagator*innerProduct(hp_src, fh_prop_src);
-		  //Instead of doing the above, I will manually specify indices.
-		  for(int fh_color_source(0);fh_color_source<Nc;fh_color_source++){
-		    //Nested spin/color loop so our dilution vectors hit every propagator component.
-		    //QDPIO::cout<<"Extracing Feynman Hellman color "<<fh_color_source<<std::endl;
-		    for(int fh_spin_source=0; fh_spin_source < Ns; fh_spin_source++){
-		      LatticeFermion fh_ferm = zero;
-		      //QDPIO::cout<<"Tying Feynman Hellman spin "<<fh_spin_source<<" to diluted hp."<<std::endl;
-		      PropToFerm(fh_prop_src, fh_ferm, fh_color_source, fh_spin_source);
-		      LatticeFermion hp_fh_ferm = zero;
-		      for(int color_source(0);color_source<Nc;color_source++){
-			LatticeColorVector vec_srce = zero ;
-			LatticeComplex HP_vec = noise_vec*vectors[vec_index];
-			pokeColor(vec_srce,HP_vec,color_source) ;
-			for(int spin_source=0; spin_source < Ns; spin_source++){
-			  LatticeFermion chi = zero;
-			  CvToFerm(vec_srce, chi, spin_source);
-			  LatticeFermion hp_ferm = zero;
-			  PropToFerm(hp_quark_propagator, hp_ferm, color_source, spin_source);
-			  hp_fh_ferm += hp_ferm*innerProduct(chi, fh_ferm);
- 			  //Only compute trace once.
- 			  if(current_index == 0 && mom == 0 && fh_color_source == 0 && fh_spin_source == 0)
-			    Trace += innerProduct(hp_ferm, chi);
-			}
-		      }
-		      FermToProp(hp_fh_ferm, hp_fh_prop, fh_color_source, fh_spin_source);
-		    }
-		  }
+		  //Diluting the hp source over spin and color makes the 144 inner products one 12x12 overlap matrix,
+		  //which is reduced in a single sweep and then multiplied into the hp prop site by site.
+		  noise_outer_product(hp_quark_propagator, HP_vec, phased_srcs[source_index - block_start], hp_fh_prop);
 		  //Below we accumulate.
-		  std::string current_id = params.named_obj.fh_prop_id[current_index*ft.numMom() + mom];
+		  std::string current_id = params.named_obj.fh_prop_id[source_index];
 		  QDPIO::cout<<"Adding outer product to prop with id "<<current_id<<std::endl;
-		  accumulated_props[current_index*ft.numMom() + mom] += hp_fh_prop;
+		  accumulated_props[source_index] += hp_fh_prop;
+		}
+		//Only delete once every block has used the hp prop.
+		if (params.hpfhparam.delete_props && last_block)
+		{
+		  // Deleting the object.
+		  TheNamedObjMap::Instance().erase(params.named_obj.hp_prop_id[vec_index]);
 		}
-	      }
-	      //Print debugger
-	      QDPIO::cout<<"HP Trace "<<vec_index+1<<" - "<<(Trace/(vec_index+1))<<std::endl;
-	      if (params.hpfhparam.delete_props)
-	      {
-		// Deleting the object.
-		TheNamedObjMap::Instance().erase(params.named_obj.hp_prop_id[vec_index]);
 	      }
 	    }
 
 	    //Divide by the total number of noise_vecs to create an average, then ship out result.
 	    for(int accumulation_index = 0; accumulation_index < accumulated_props.size(); accumulation_index++)
 	    {
-	      accumulated_props[accumulation_index] /= vectors.size();
+	      accumulated_props[accumulation_index] /= num_vecs;
 	      push(xml_out,"Relaxation_Iterations");
 	      //ncg_had not needed since no inversion is happening
 	      //write(xml_out, "ncg_had", ncg_had);
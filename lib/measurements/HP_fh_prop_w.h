@@ -48,6 +48,7 @@ namespace Chroma
 	Seed ran_seed; 			      //seed value, keeping this the same for hp_fh and disco is crucial!
 	int ZN;                               //the type of random noise
 	bool delete_props;                    // Delete props after being summed, by default this is turned off.
+	int source_cache_size;                // Max number of current-inserted sources held at once, <= 0 means all of them.
       } hpfhparam ;
 
       struct NamedObject_t
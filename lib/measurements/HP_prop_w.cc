@@ -23,11 +23,14 @@ OUTPUT
 #include "util/info/unique_id.h"
 //We need this to insert Fermions to a Prop, this is imperitive for dilution.
 #include "util/ferm/transf.h"
+#include <algorithm>
 
 // Lalibe Stuff
 #include "HP_prop_w.h"
+#include "../numerics/fermion_state_cache_w.h"
+#include "../numerics/block_solve_w.h"
 //#include "../numerics/binaryRecursiveColoring.h"
-#include "../numerics/binaryRecursiveColoring_v2.h"
+#include "../numerics/noise_source_w.h"
 
 namespace Chroma
 {
@@ -65,6 +68,19 @@ namespace Chroma
 	    read(paramtop, "ending_vector" ,par.ending_vector ); 
 	    read(paramtop, "Seed" ,par.ran_seed ); 
 	    read(paramtop, "ZN" ,par.ZN ); 
+	    if (paramtop.count("multi_rhs") != 0)
+	      read(paramtop, "multi_rhs" ,par.multi_rhs );
+	    else
+	      par.multi_rhs = false;
+	    if (paramtop.count("mrhs_vectors") != 0)
+	      read(paramtop, "mrhs_vectors" ,par.mrhs_vectors );
+	    else
+	      par.mrhs_vectors = 1;
+	    if (par.mrhs_vectors < 1)
+	    {
+	      QDPIO::cerr << "mrhs_vectors must be at least 1, got " << par.mrhs_vectors << std::endl;
+	      QDP_abort(1);
+	    }
         }
 
         void write(XMLWriter& xml, const std::string& path, HPParams::HPProp_t& par)
@@ -75,6 +91,8 @@ namespace Chroma
 	    write(xml, "ending_vector" ,par.ending_vector); 
 	    write(xml, "Seed" ,par.ran_seed);
 	    write(xml, "ZN" ,par.ZN);
+	    write(xml, "multi_rhs" ,par.multi_rhs);
+	    write(xml, "mrhs_vectors" ,par.mrhs_vectors);
             pop(xml);
 
         }
@@ -174,147 +192,47 @@ namespace Chroma
 	    typedef multi1d<LatticeColorMatrix> P;
 	    typedef multi1d<LatticeColorMatrix> Q;
 
-	    std::istringstream xml_action(params.hpparam.prop_param.fermact.xml);
-	    XMLReader action_reader(xml_action);
-	    Handle<FermionAction<T, P, Q>> action(TheFermionActionFactory::Instance().createObject(params.hpparam.prop_param.fermact.id, action_reader, params.hpparam.prop_param.fermact.path));
-	    Handle<FermState<T, P, Q>> action_state(action->createState(u));
+	    LalibeFermStateCache& ferm_cache = lalibeFermStateCache(params.hpparam.prop_param.fermact, params.named_obj.gauge_id, u);
+	    Handle<FermionAction<T, P, Q>> action = ferm_cache.action;
+	    Handle<FermState<T, P, Q>> action_state = ferm_cache.state;
 	    Handle<SystemSolver<LatticeFermion>> solver = action->qprop(action_state, params.hpparam.prop_param.invParam);
 	    QDPIO::cout<<"Our action and fermion state are doing A-okay so far."<<std::endl;
 	    //We are going to manually do Nc*Ns inversions, looping over spin/color and creating and solved noise propagator which doesn't require header stuff.
 
 	    //Here's where the actual noisy stuff happens.
-	    LatticeComplex noise_vec ;
-	    Seed ran_seed;
-	    QDP::RNG::savern(ran_seed);
-
-	    // Set the seed to desired value
-	    QDP::RNG::setrn(params.hpparam.ran_seed);
-
-	    int ZN  = params.hpparam.ZN;
-	    LatticeReal rnd1, theta;
-	    // twopi defined in chroma/lib/chromabase.h
-	    Real twopiN = Chroma::twopi / ZN; 
-	    random(rnd1); 
-	    theta = twopiN * floor(ZN*rnd1);
-	    noise_vec = cmplx(cos(theta),sin(theta));
-	    
-	    //restore the seed
-	    QDP::RNG::setrn(ran_seed);
-	    
-	    //Here is where the HP stuff is created; adopted from Andrea's main function. 
-	    struct meshVars mesh;
-	    unsigned int i, N, Hpsize, sample;
-	    unsigned int *perm, *Hperm;
-	    //double *RHS;
-
-	    mesh.d = Nd;
-	    mesh.ptsPerDim = (unsigned int *)malloc(sizeof(unsigned int)*mesh.d);
-	    N=1;
-	    for (i=0;i<mesh.d; i++){
-	      //printf("dim(%u): ",i);
-	      //scanf("%u", &mesh.ptsPerDim[i]);
-	      //This logic is taken from Bit Twiddling Hacks by Sean Anderson, September 5, 2010
-	      unsigned int v = Layout::lattSize()[i]; // compute the next highest power of 2 of 32-bit v
-              v--;
-              v |= v >> 1;
-              v |= v >> 2;
-              v |= v >> 4;
-              v |= v >> 8;
-              v |= v >> 16;
-              v++;
-	      //mesh.ptsPerDim[i] = Layout::lattSize()[i];
-	      //Extend HP to beyond purely powers of two.
-	      mesh.ptsPerDim[i] = v;
-	      N *= mesh.ptsPerDim[i];
-	    }
-	    
-	    /* Set up the hierarchical data structs */
-	    hierOrderSetUp(&mesh);
-
-	    /* Find the row permutation once for each point in local mesh*/
-	    /* Here it's done for all nodes N. But can be done only for local ones */
-	    perm = (unsigned int *)malloc(sizeof(unsigned int)*N);
-	    hierPerm(&mesh, perm, N);
-	    
-	    /* Now with the perm obtained we do not need the mesh any more */
-	    freeMeshVars(&mesh);
-
-	    /* Create the column permutation of the Hadamard vectors. Do it once */
-	    /* Create only for as many columns as you need. For example 1024 or 4096 */
-	    /* CAUTION: N is the global size (total spatial dimension of the mesh) */
-	    /* CAUTION: N must be a power of 2 */
-	    //Hpsize = 1024;
-	    Hpsize = params.hpparam.ending_vector;
-	    Hperm = (unsigned int *)malloc(sizeof(unsigned int)*Hpsize);
-	    hadaColPerm(N, Hperm, Hpsize);
-	    /**********************************************************************/
-	    /* At this point we are ready to create the permuted Hadamard vectors */
-	    /* What is needed is perm and Hperm */
-	    /**********************************************************************/
-	    
-	    //Object to hold HP vectors we want to invert
-	    multi1d <LatticeInteger> vectors;
-	    vectors.resize(params.hpparam.ending_vector - params.hpparam.starting_vector + 1);
-	    
-	    //Back to code adopted from Andrea's main function.
-	    //for (sample=0; sample<Hpsize; sample++) {
-	       ///* I create all N here, but it can be done on local rows only */
-	       //for (i=0;i<N;i++) 
-		  //RHS[i] = (double) Hada_element(perm[i], Hperm[sample]);
-
-	       ///* use RHS in trace computation */
-	    //}
-	   
-	    int Nx = Layout::lattSize()[0];
-	    int Ny = Layout::lattSize()[1];
-	    int Nz = Layout::lattSize()[2];
-	    int Nt = Layout::lattSize()[3];
-	    for(int HP_index = params.hpparam.starting_vector; HP_index < params.hpparam.ending_vector + 1; HP_index++)
-	    {
-	      QDPIO::cout<<"Building HP vector number "<<HP_index<<std::endl;
-	      for(int x = 0; x < Nx; x++)
-		for(int y = 0; y < Ny; y++)
-		  for(int z = 0; z < Nz; z++)
-		    for(int t = 0; t < Nt; t++)
-		    {
-		      multi1d<int> chroma_coords;
-		      chroma_coords.resize(Nd);
-		      chroma_coords[0] = x; chroma_coords[1] = y; chroma_coords[2] = z; chroma_coords[3] = t;
-		      int i = Layout::linearSiteIndex(chroma_coords);
-		      int element = Hada_element(perm[i], (Hperm[HP_index - 1]));
-		      Integer chroma_element = element;
-		      pokeSite(vectors[HP_index - params.hpparam.starting_vector], chroma_element, chroma_coords);
-		    }
-	    }
+	    //Each probing vector is made when it is needed, from the seed and its vector number.
+	    HPNoiseSource probes(params.hpparam.ran_seed, params.hpparam.ZN, params.hpparam.ending_vector);
+	    const int num_vecs = params.hpparam.ending_vector - params.hpparam.starting_vector + 1;
 
 	    //For debugging HP vectors.
 	    ComplexD Trace = 0.0;
-	    for(int vec_index = 0; vec_index < vectors.size(); vec_index++)
+	    //The diluted sources of mrhs_vectors HP vectors are solved together, in one multi-rhs call if asked for.
+	    const int dilutions = Nc*Ns;
+	    const int batch_vectors = params.hpparam.multi_rhs ? params.hpparam.mrhs_vectors : 1;
+	    for(int batch_start = 0; batch_start < num_vecs; batch_start += batch_vectors)
 	    {
+	     const int batch_end = std::min(batch_start + batch_vectors, num_vecs);
+	     multi1d<LatticeFermion> chi((batch_end - batch_start)*dilutions);
+	     multi1d<LatticeFermion> noise_soln((batch_end - batch_start)*dilutions);
+	     //Now let's do some dilution...
+	     for(int vec_index = batch_start; vec_index < batch_end; vec_index++)
+	     {
 	       QDPIO::cout<<"Inverting hierarchnical probing vector number "<<vec_index+1<<std::endl;
-	       LatticePropagator noise_prop = zero;
-	       //Now let's do some dilution...
-	       for(int color_source(0);color_source<Nc;color_source++){
-		 QDPIO::cout << "color_source = " << color_source << std::endl; 
-		 
-		 LatticeColorVector vec_srce = zero ;
-		 LatticeComplex HP_vec = noise_vec*vectors[vec_index];
-		 pokeColor(vec_srce,HP_vec,color_source) ;
-		 
-		 for(int spin_source=0; spin_source < Ns; ++spin_source){
-		   QDPIO::cout << "spin_source = " << spin_source << std::endl; 
-		   
-		   // Insert a ColorVector into spin index spin_source
-		   // This only overwrites sections, so need to initialize first
-		   // Also, do the solve here
-		   LatticeFermion chi = zero;
-		   LatticeFermion noise_soln = zero;
-		   CvToFerm(vec_srce, chi, spin_source);
-		   SystemSolverResults_t res = (*solver)(noise_soln, chi);
-		   Trace += innerProduct(noise_soln, chi);
-		   FermToProp(noise_soln, noise_prop, color_source, spin_source); 
-		 }
-	       }
+	       LatticeComplex HP_vec;
+	       probes(params.hpparam.starting_vector + vec_index, HP_vec);
+	       spin_color_dilute(HP_vec, chi, (vec_index - batch_start)*dilutions);
+	     }
+	     for(int rhs = 0; rhs < noise_soln.size(); rhs++)
+	       noise_soln[rhs] = zero;
+	     multi1d<SystemSolverResults_t> res = block_solve(*solver, noise_soln, chi, params.hpparam.multi_rhs);
+
+	     for(int vec_index = batch_start; vec_index < batch_end; vec_index++)
+	     {
+	      LatticePropagator noise_prop = zero;
+	      const int offset = (vec_index - batch_start)*dilutions;
+	      for(int rhs = offset; rhs < offset + dilutions; rhs++)
+		Trace += innerProduct(noise_soln[rhs], chi[rhs]);
+	      spin_color_to_prop(noise_soln, offset, noise_prop);
 	      
 	      QDPIO::cout<<"HP Trace "<<vec_index+1<<" - "<<(Trace/(vec_index+1))<<std::endl;
 	      //Fake some propagator info that isn't relevant for stochastic ones.
@@ -335,6 +253,7 @@ namespace Chroma
 	      TheNamedObjMap::Instance().get(current_id).setFileXML(file_xml);
 	      TheNamedObjMap::Instance().get(current_id).setRecordXML(record_xml);
   	      QDPIO::cout<<"Passed noise vector: "<<current_id<<"to the Named Object Buffer."<<std::endl;
+	     }
 	    }
 	    snoop.stop();
 	    QDPIO::cout << LalibeHPPropagatorEnv::name << ": total time = " << snoop.getTimeInSeconds() << " secs" << std::endl;
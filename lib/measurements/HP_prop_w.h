@@ -45,6 +45,8 @@ namespace Chroma
 	Seed ran_seed; 			      //seed value, keeping this the same for stoch_fh and disco is crucial!
 	int ZN;                               //the type of random noise
 	ChromaProp_t prop_param;              //params for next lin solve
+	bool multi_rhs;                       //hand the diluted sources to a multi-rhs solver in one call, if chroma has one
+	int mrhs_vectors;                     //number of noise vectors whose Nc*Ns sources go into each multi-rhs call
       } hpparam ;
 
       struct NamedObject_t
@@ -23,9 +23,13 @@ OUTPUT
 #include "util/info/unique_id.h"
 //We need this to insert Fermions to a Prop, this is imperitive for dilution.
 #include "util/ferm/transf.h"
+#include <algorithm>
 
 // Lalibe Stuff
 #include "ZN_prop_w.h"
+#include "../numerics/fermion_state_cache_w.h"
+#include "../numerics/block_solve_w.h"
+#include "../numerics/noise_source_w.h"
 
 namespace Chroma
 {
@@ -63,6 +67,23 @@ namespace Chroma
 	    read(paramtop, "ending_vector" ,par.ending_vector ); 
 	    read(paramtop, "Seed" ,par.ran_seed ); 
 	    read(paramtop, "ZN" ,par.ZN ); 
+	    if (paramtop.count("noise_engine") != 0)
+	      read(paramtop, "noise_engine" ,par.noise_engine );
+	    else
+	      par.noise_engine = "qdp";
+	    if (paramtop.count("multi_rhs") != 0)
+	      read(paramtop, "multi_rhs" ,par.multi_rhs );
+	    else
+	      par.multi_rhs = false;
+	    if (paramtop.count("mrhs_vectors") != 0)
+	      read(paramtop, "mrhs_vectors" ,par.mrhs_vectors );
+	    else
+	      par.mrhs_vectors = 1;
+	    if (par.mrhs_vectors < 1)
+	    {
+	      QDPIO::cerr << "mrhs_vectors must be at least 1, got " << par.mrhs_vectors << std::endl;
+	      QDP_abort(1);
+	    }
         }
 
         void write(XMLWriter& xml, const std::string& path, ZNParams::ZNProp_t& par)
@@ -73,6 +94,9 @@ namespace Chroma
 	    write(xml, "ending_vector" ,par.ending_vector); 
 	    write(xml, "Seed" ,par.ran_seed);
 	    write(xml, "ZN" ,par.ZN);
+	    write(xml, "noise_engine" ,par.noise_engine);
+	    write(xml, "multi_rhs" ,par.multi_rhs);
+	    write(xml, "mrhs_vectors" ,par.mrhs_vectors);
             pop(xml);
 
         }
@@ -172,65 +196,42 @@ namespace Chroma
 	    typedef multi1d<LatticeColorMatrix> P;
 	    typedef multi1d<LatticeColorMatrix> Q;
 
-	    std::istringstream xml_action(params.znparam.prop_param.fermact.xml);
-	    XMLReader action_reader(xml_action);
-	    Handle<FermionAction<T, P, Q>> action(TheFermionActionFactory::Instance().createObject(params.znparam.prop_param.fermact.id, action_reader, params.znparam.prop_param.fermact.path));
-	    Handle<FermState<T, P, Q>> action_state(action->createState(u));
+	    LalibeFermStateCache& ferm_cache = lalibeFermStateCache(params.znparam.prop_param.fermact, params.named_obj.gauge_id, u);
+	    Handle<FermionAction<T, P, Q>> action = ferm_cache.action;
+	    Handle<FermState<T, P, Q>> action_state = ferm_cache.state;
 	    Handle<SystemSolver<LatticeFermion>> solver = action->qprop(action_state, params.znparam.prop_param.invParam);
 	    QDPIO::cout<<"Our action and fermion state are doing A-okay so far."<<std::endl;
 	    //We are going to manually do Nc*Ns inversions, looping over spin/color and creating and solved noise propagator which doesn't require header stuff.
 
 	    //Here's where the actual noisy stuff happens.
-	    multi1d <LatticeComplex> vectors;
-	    vectors.resize(params.znparam.ending_vector - params.znparam.starting_vector + 1);
-	    LatticeComplex vec ;
-	    Seed ran_seed;
-	    QDP::RNG::savern(ran_seed);
-
-	    // Set the seed to desired value
-	    QDP::RNG::setrn(params.znparam.ran_seed);
+	    //Each vector is made when it is needed, straight from the seed and its vector number.
+	    Handle<LalibeNoiseSource> noise = lalibeZNNoiseSource(params.znparam.noise_engine, params.znparam.ran_seed, params.znparam.ZN);
+	    const int num_vecs = params.znparam.ending_vector - params.znparam.starting_vector + 1;
 
-	    for(int current_vec = 0; current_vec < params.znparam.ending_vector; current_vec++)
+	    //The diluted sources of mrhs_vectors noise vectors are solved together, in one multi-rhs call if asked for.
+	    const int dilutions = Nc*Ns;
+	    const int batch_vectors = params.znparam.multi_rhs ? params.znparam.mrhs_vectors : 1;
+	    for(int batch_start = 0; batch_start < num_vecs; batch_start += batch_vectors)
 	    {
-	      int N  = params.znparam.ZN;
-	      LatticeReal rnd1, theta;
-	      // twopi defined in chroma/lib/chromabase.h
-	      Real twopiN = Chroma::twopi / N; 
-	      random(rnd1); 
-	      theta = twopiN * floor(N*rnd1);
-	      vec = cmplx(cos(theta),sin(theta));
-	      if ((current_vec + 1) >= params.znparam.starting_vector)
-	        vectors[current_vec - params.znparam.starting_vector + 1] = vec; 
-	    }
-	    
-	    //restore the seed
-	    QDP::RNG::setrn(ran_seed);
-
+	     const int batch_end = std::min(batch_start + batch_vectors, num_vecs);
+	     multi1d<LatticeFermion> chi((batch_end - batch_start)*dilutions);
+	     multi1d<LatticeFermion> noise_soln((batch_end - batch_start)*dilutions);
+	     //Now let's do some dilution...
+	     for(int vec_index = batch_start; vec_index < batch_end; vec_index++)
+	     {
+	       LatticeComplex vec;
+	       (*noise)(params.znparam.starting_vector + vec_index, vec);
+	       spin_color_dilute(vec, chi, (vec_index - batch_start)*dilutions);
+	     }
+	     for(int rhs = 0; rhs < noise_soln.size(); rhs++)
+	       noise_soln[rhs] = zero;
+	     QDPIO::cout << "Solving noise vectors " << batch_start << " to " << batch_end - 1 << std::endl;
+	     multi1d<SystemSolverResults_t> res = block_solve(*solver, noise_soln, chi, params.znparam.multi_rhs);
 
-	    for(int vec_index = 0; vec_index < vectors.size(); vec_index++)
-	    {
-	       LatticePropagator noise_prop = zero;
-	       //Now let's do some dilution...
-	       for(int color_source(0);color_source<Nc;color_source++){
-		 QDPIO::cout << "color_source = " << color_source << std::endl; 
-		 
-		 LatticeColorVector vec_srce = zero ;
-		 //	      pokeColor(tmp,wave[k],color_source) ;
-		 pokeColor(vec_srce,vectors[vec_index],color_source) ;
-		 
-		 for(int spin_source=0; spin_source < Ns; ++spin_source){
-		   QDPIO::cout << "spin_source = " << spin_source << std::endl; 
-		   
-		   // Insert a ColorVector into spin index spin_source
-		   // This only overwrites sections, so need to initialize first
-		   // Also, do the solve here
-		   LatticeFermion chi = zero;
-		   LatticeFermion noise_soln = zero;
-		   CvToFerm(vec_srce, chi, spin_source);
-		   SystemSolverResults_t res = (*solver)(noise_soln, chi);
-		   FermToProp(noise_soln, noise_prop, color_source, spin_source); 
-		 }
-	       }
+	     for(int vec_index = batch_start; vec_index < batch_end; vec_index++)
+	     {
+	      LatticePropagator noise_prop = zero;
+	      spin_color_to_prop(noise_soln, (vec_index - batch_start)*dilutions, noise_prop);
 
 	      //Fake some propagator info that isn't relevant for stochastic ones.
 	      XMLBufferWriter file_xml;
@@ -250,6 +251,7 @@ namespace Chroma
 	      TheNamedObjMap::Instance().get(current_id).setFileXML(file_xml);
 	      TheNamedObjMap::Instance().get(current_id).setRecordXML(record_xml);
   	      QDPIO::cout<<"Passed noise vector: "<<current_id<<"to the Named Object Buffer."<<std::endl;
+	     }
 	    }
 	    snoop.stop();
 	    QDPIO::cout << LalibeZNPropagatorEnv::name << ": total time = " << snoop.getTimeInSeconds() << " secs" << std::endl;
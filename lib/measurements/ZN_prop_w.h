@@ -44,7 +44,10 @@ namespace Chroma
 	int ending_vector;                    //ending vector number
 	Seed ran_seed; 			      //seed value, keeping this the same for stoch_fh and disco is crucial!
 	int ZN;                               //the type of random noise
+	std::string noise_engine;              //"qdp" (default) or "counter", must match between the ZN inversion and its contractions
 	ChromaProp_t prop_param;              //params for next lin solve
+	bool multi_rhs;                       //hand the diluted sources to a multi-rhs solver in one call, if chroma has one
+	int mrhs_vectors;                     //number of noise vectors whose Nc*Ns sources go into each multi-rhs call
       } znparam ;
 
       struct NamedObject_t
@@ -11,11 +11,14 @@
 
 #include "baryon_contractions_w.h"
 #include "../contractions/baryon_contractions_func_w.h"
+#include "../contractions/contraction_precision.h"
 #include "meas/inline/abs_inline_measurement_factory.h"
 #include "../momentum/lalibe_sftmom.h"
+#include "../io/hdf5_writer_cache.h"
 #include "meas/inline/io/named_objmap.h"
 #include "io/qprop_io.h"
 
+#include <algorithm>
 #include <set>
 
 
@@ -57,6 +60,13 @@ namespace Chroma
       read(paramtop, "h5_file_name", par.file_name);
       read(paramtop, "path", par.obj_path);
       QDPIO::cout<<"HDF5 found, writing to"<<par.file_name<<" to path "<<par.obj_path<<std::endl;
+      if (paramtop.count("aggregate_output") != 0)
+      {
+	read(paramtop, "aggregate_output" ,par.aggregate_output);
+	QDPIO::cout<<"Aggregated correlator output set to "<<par.aggregate_output<<std::endl;
+      }
+      else
+	par.aggregate_output = false;
 #endif
       //We set output_full_correlator to true if no momentum is specified.
       //read(paramtop, "output_full_correlator", par.output_full_correlator);
@@ -114,6 +124,35 @@ namespace Chroma
 	  par.is_mom_max = true;
 	  par.p2_max = 0;
       }
+      if (paramtop.count("ft_mode") != 0)
+      {
+	read(paramtop, "ft_mode" ,par.ft_mode);
+	lalibeSftModeFromString(par.ft_mode);
+	QDPIO::cout<<"Momentum projection mode set to "<<par.ft_mode<<std::endl;
+      }
+      else
+	par.ft_mode = "phases";
+      if (paramtop.count("precision") != 0)
+      {
+	read(paramtop, "precision" ,par.precision);
+	lalibePrecisionFromString(par.precision);
+	QDPIO::cout<<"Contraction precision set to "<<par.precision<<std::endl;
+      }
+      else
+	par.precision = "double";
+      if (paramtop.count("t_range") != 0)
+      {
+	read(paramtop, "t_range" ,par.t_range);
+	if (par.t_range.size() != 2 || par.t_range[1] < par.t_range[0])
+	{
+	  QDPIO::cerr<<"t_range must be two time slices t_min t_max (relative to the source) with t_min <= t_max"<<std::endl;
+	  QDP_abort(1);
+	}
+	par.use_t_range = true;
+	QDPIO::cout<<"Only contracting time slices "<<par.t_range[0]<<" to "<<par.t_range[1]<<" relative to the source"<<std::endl;
+      }
+      else
+	par.use_t_range = false;
 
       multi1d<std::string> tmpPartList;
       read(paramtop, "particle_list", tmpPartList);
@@ -161,12 +200,17 @@ namespace Chroma
 #ifdef BUILD_HDF5
       write(xml, "h5_file_name", par.file_name);
       write(xml, "path", par.obj_path);
+      write(xml, "aggregate_output", par.aggregate_output);
 #endif
       //write(xml, "output_full_correlator", par.output_full_correlator);
       if(par.is_mom_max == true)
 	write(xml, "p2_max" ,par.p2_max);
       else
 	write(xml, "mom_list" ,par.mom_list);
+      write(xml, "ft_mode", par.ft_mode);
+      write(xml, "precision", par.precision);
+      if(par.use_t_range == true)
+	write(xml, "t_range", par.t_range);
       //write(xml, "particle_list", par.particle_list);
 
       pop(xml);
@@ -278,6 +322,12 @@ namespace Chroma
       //Grab all the propagators that are given.
       std::vector<char> quark_flavs { 'u', 'd', 's', 'c' };
       std::map<char, LatticePropagator> prop_map;
+      LalibeContractionPrecision precision = lalibePrecisionFromString(params.param.precision);
+#if BASE_PRECISION==64
+      //Single precision contractions: each propagator is rounded down as it is read, so the task never holds
+      //a double copy of it, only validate keeps both.
+      std::map<char, LatticePropagatorF> prop_map_f;
+#endif
       //Need origin, j_decay, and t0 for fourier transform!
       //Need j_decay of bc to know what comes with a minus sign.
       int j_decay;
@@ -296,7 +346,23 @@ namespace Chroma
 
 	  try
 	  {
-	    prop_map[aFlav] = TheNamedObjMap::Instance().getData<LatticePropagator>(qIt->second);
+	    const LatticePropagator& stored_prop = TheNamedObjMap::Instance().getData<LatticePropagator>(qIt->second);
+#if BASE_PRECISION==64
+	    if (precision == CONTRACT_SINGLE)
+	    {
+	      //Only a rotation needs a double work copy, and it is dropped straight after.
+	      if(params.param.rotate_to_Dirac == true)
+	      {
+		LatticePropagator rotated_prop = stored_prop;
+		rotate_to_Dirac_Basis(rotated_prop);
+		prop_map_f[aFlav] = rotated_prop;
+	      }
+	      else
+		prop_map_f[aFlav] = stored_prop;
+	    }
+	    else
+#endif
+	      prop_map[aFlav] = stored_prop;
 
 	    XMLReader prop_file_xml, prop_record_xml;
 	    TheNamedObjMap::Instance().get(qIt->second).getFileXML(prop_file_xml);
@@ -341,7 +407,7 @@ namespace Chroma
 	      }
 	    } // check of origin, t0, j_decay between props
 	    //If we need to rotate, we do it now.
-	    if(params.param.rotate_to_Dirac == true)
+	    if(params.param.rotate_to_Dirac == true && prop_map.count(aFlav) != 0)
 	      rotate_to_Dirac_Basis(prop_map[aFlav]);
 	  }
 	  catch (std::bad_cast)
@@ -364,15 +430,19 @@ namespace Chroma
 
 
       //Initialize FT stuff here, whether this is used or not below is another story...
-      LalibeSftMom ft = params.param.is_mom_max ? LalibeSftMom(params.param.p2_max, origin, false, j_decay)
-	: LalibeSftMom(params.param.p_list, origin, j_decay);
+      LalibeSftMode ft_mode = lalibeSftModeFromString(params.param.ft_mode);
+      LalibeSftMom ft = params.param.is_mom_max ? LalibeSftMom(params.param.p2_max, origin, false, j_decay, ft_mode)
+	: LalibeSftMom(params.param.p_list, origin, j_decay, ft_mode);
+      //Restrict everything below to the requested time slices.
+      if(params.param.use_t_range)
+	ft.setTimeWindow(t_0 + params.param.t_range[0], params.param.t_range[1] - params.param.t_range[0] + 1);
 
       //Here's Nt, we need this.
       int Nt = Layout::lattSize()[j_decay];
 
 #ifdef BUILD_HDF5
       //If we are writing with hdf5, the start up is done here.
-      HDF5Writer h5out(params.param.file_name);
+      HDF5Writer& h5out = lalibeHDF5Writer(params.param.file_name);
       //h5out.push(params.param.obj_path);
       HDF5Base::writemode wmode;
       wmode = HDF5Base::ate;
@@ -390,40 +460,118 @@ namespace Chroma
       }
 
       for (auto aProp : reqProps) {
+#if BASE_PRECISION==64
+	if (precision == CONTRACT_SINGLE && prop_map_f.find(aProp) != prop_map_f.end())
+	  continue;
+#endif
 	if (prop_map.find(aProp) == prop_map.end()) {
 	  QDPIO::cerr << "Could not find required propagator for "<<aProp<<" quark"<<std::endl;
 	  QDP_abort(1);
 	}
       }
 
-      //If flavor check has passed, now we loop through particles and do the contractions.
-      for (auto aParticle : params.param.particle_list)
+      //If flavor check has passed, do all the contractions in one batch so shared spin slices
+      //and color contractions are only computed once, then write them out.
+      QDPIO::cout<<"Starting contractions for "<<params.param.particle_list.size()<<" baryon spin components..."<<std::endl;
+      std::map<std::pair<std::string, std::string>, LatticeComplex> baryons;
+      if (precision != CONTRACT_SINGLE)
+	do_contractions(prop_map, params.param.particle_list, baryons, ft.getWindow());
+
+#if BASE_PRECISION==64
+      //Validate rounds its double copies down here, single already read them in single precision.
+      std::map<std::pair<std::string, std::string>, LatticeComplexF> baryons_f;
+      if (precision != CONTRACT_DOUBLE)
       {
-	QDPIO::cout<<"Starting "<<aParticle.first<<" "<<aParticle.second<<" contraction..."<<std::endl;
+	for (const auto& aProp : prop_map)
+	  prop_map_f[aProp.first] = aProp.second;
+	do_contractions(prop_map_f, params.param.particle_list, baryons_f, ft.getWindow());
+	prop_map_f.clear();
+      }
 
-	auto flavCode = get_flavor_code(aParticle.first);
+      if (precision == CONTRACT_VALIDATE)
+      {
+	std::vector<const LatticeComplex*> baryon_list;
+	std::vector<const LatticeComplexF*> baryon_list_f;
+	for (auto aParticle : params.param.particle_list)
+	{
+	  baryon_list.push_back(&baryons[aParticle]);
+	  baryon_list_f.push_back(&baryons_f[aParticle]);
+	}
+	multi1d<multi2d<DComplex>> FTed = ft.sft(baryon_list);
+	multi1d<multi2d<DComplex>> FTed_f = ft.sft(baryon_list_f);
+
+	double max_dev = 0.0;
+	for (int iBaryon = 0; iBaryon < FTed.size(); iBaryon++)
+	  max_dev = std::max(max_dev, maxRelativeDeviation(FTed[iBaryon], FTed_f[iBaryon]));
+	QDPIO::cout<<name<<": max relative deviation of single from double precision correlators = "<<max_dev<<std::endl;
+	push(xml_out, "PrecisionValidation");
+	write(xml_out, "max_rel_deviation", max_dev);
+	pop(xml_out);
+      }
+#endif
 
-	LatticeComplex baryon = zero;
+      if (params.param.output_full_correlator)
+      {
+	for (auto aParticle : params.param.particle_list)
+	{
+	  QDPIO::cout<<"Writing "<<aParticle.first<<" "<<aParticle.second<<" correlator..."<<std::endl;
 
-	do_contraction(prop_map[std::get<0>(flavCode)],
-	    	       prop_map[std::get<1>(flavCode)],
-		       prop_map[std::get<2>(flavCode)],
-		       aParticle.first,
-		       aParticle.second,
-		       baryon);
+#if BASE_PRECISION==64
+	  if (precision == CONTRACT_SINGLE)
+	    baryons[aParticle] = baryons_f[aParticle];
+#endif
+	  write_correlator(params.param.output_full_correlator, params.param.is_antiperiodic,
+	      aParticle.first, aParticle.second,
+#ifdef BUILD_HDF5
+	      params.param.obj_path, h5out, wmode,
+#endif
+	      t_0, Nt, origin, ft, baryons[aParticle]);
+	}
+      }
+      else
+      {
+	//Project every correlator in one sweep, then write them out.
+	multi1d<multi2d<DComplex>> FTed_baryons;
+#if BASE_PRECISION==64
+	if (precision == CONTRACT_SINGLE)
+	{
+	  std::vector<const LatticeComplexF*> baryon_list_f;
+	  for (auto aParticle : params.param.particle_list)
+	    baryon_list_f.push_back(&baryons_f[aParticle]);
+	  FTed_baryons = ft.sft(baryon_list_f);
+	}
+	else
+#endif
+	{
+	  std::vector<const LatticeComplex*> baryon_list;
+	  for (auto aParticle : params.param.particle_list)
+	    baryon_list.push_back(&baryons[aParticle]);
+	  FTed_baryons = ft.sft(baryon_list);
+	}
 
-	write_correlator(params.param.output_full_correlator, params.param.is_antiperiodic,
-	    aParticle.first, aParticle.second,
 #ifdef BUILD_HDF5
-	    params.param.obj_path, h5out, wmode,
+	LalibeCorrelatorBuffer buffer(ft, Nt);
+	LalibeCorrelatorBuffer * aggregate = params.param.aggregate_output ? &buffer : NULL;
 #endif
-	    t_0, Nt, origin, ft, baryon);
+	int iBaryon = 0;
+	for (auto aParticle : params.param.particle_list)
+	{
+	  QDPIO::cout<<"Writing "<<aParticle.first<<" "<<aParticle.second<<" correlator..."<<std::endl;
 
+	  write_correlator(params.param.is_antiperiodic,
+	      aParticle.first, aParticle.second,
+#ifdef BUILD_HDF5
+	      params.param.obj_path, h5out, wmode, aggregate,
+#endif
+	      t_0, Nt, origin, ft, FTed_baryons[iBaryon++]);
+	}
+#ifdef BUILD_HDF5
+	buffer.write(params.param.obj_path, origin, h5out, wmode);
+#endif
       }
 
 #ifdef BUILD_HDF5
       h5out.cd("/");
-      h5out.close();
 #endif
 
       //pop(xml_out);
@@ -22,11 +22,15 @@ OUTPUT
 #include "fermact.h"
 #include "actions/ferm/fermacts/fermact_factory_w.h"
 #include "util/info/unique_id.h"
+#include "util/ferm/transf.h"
+#include <algorithm>
 
 // Lalibe Stuff
 #include "../momentum/lalibe_sftmom.h"
 #include "fh_prop_w.h"
+#include "../numerics/fermion_state_cache_w.h"
 #include "../matrix_elements/bilinear_gamma.h"
+#include "../numerics/block_solve_w.h"
 
 namespace Chroma
 {
@@ -41,6 +45,33 @@ namespace Chroma
             }
             //! Local registration flag
             bool registered = false;
+
+	    //! Hand a solved FH propagator to the Named Object Buffer, with the header of the source prop
+	    void store_fh_prop(const std::string& current_id, const LatticePropagator& fh_prop_solution,
+			       XMLReader& prop_record_xml, const ChromaProp_t& prop_param)
+	    {
+  	        QDPIO::cout << "Writing propagator info, cause why not?" << std::endl;
+  	        XMLBufferWriter file_xml;
+  	        push(file_xml, "propagator");
+  	        write(file_xml, "id", uniqueId());  // NOTE: new ID form
+  	        pop(file_xml);
+
+  	        //If ths src is not from make source these thing is not going to work...
+  	        XMLBufferWriter record_xml;
+  	        MakeSourceProp_t  orig_header;
+  	        read(prop_record_xml, "/Propagator", orig_header);
+  	        Propagator_t  new_header;   // note, abandoning state_info
+  	        new_header.prop_header   = prop_param;
+  	        new_header.source_header = orig_header.source_header;
+  	        new_header.gauge_header  = orig_header.gauge_header;
+  	        write(record_xml, "Propagator", new_header);
+
+  	        TheNamedObjMap::Instance().create<LatticePropagator>(current_id);
+  	        TheNamedObjMap::Instance().getData<LatticePropagator>(current_id) = fh_prop_solution;
+  	        TheNamedObjMap::Instance().get(current_id).setFileXML(file_xml);
+  	        TheNamedObjMap::Instance().get(current_id).setRecordXML(record_xml);
+  	        QDPIO::cout<<"YAAAY! We finished current: "<<current_id<<std::endl;
+	    }
         }
         const std::string name = "FH_PROPAGATOR";
 
@@ -99,6 +130,23 @@ namespace Chroma
       		par.is_mom_max = true;
       		par.p2_max = 0;
 	    }
+	    if (paramtop.count("batch_solve") != 0)
+	      read(paramtop, "batch_solve" ,par.batch_solve);
+	    else
+	      par.batch_solve = false;
+	    if (paramtop.count("batch_insertions") != 0)
+	      read(paramtop, "batch_insertions" ,par.batch_insertions);
+	    else
+	      par.batch_insertions = 1;
+	    if (par.batch_insertions < 1)
+	    {
+	      QDPIO::cerr << "batch_insertions must be at least 1, got " << par.batch_insertions << std::endl;
+	      QDP_abort(1);
+	    }
+	    if (paramtop.count("initial_guess") != 0)
+	      read(paramtop, "initial_guess" ,par.initial_guess);
+	    else
+	      par.initial_guess = false;
         }
 
         void write(XMLWriter& xml, const std::string& path, FHParams::FHProp_t& par)
@@ -112,6 +160,9 @@ namespace Chroma
 	      write(xml, "p2_max" ,par.p2_max);
 	    else
 	      write(xml, "mom_list" ,par.mom_list);
+	    write(xml, "batch_solve" ,par.batch_solve);
+	    write(xml, "batch_insertions" ,par.batch_insertions);
+	    write(xml, "initial_guess" ,par.initial_guess);
             pop(xml);
 
         }
@@ -250,10 +301,9 @@ namespace Chroma
 	    typedef multi1d<LatticeColorMatrix> P;
 	    typedef multi1d<LatticeColorMatrix> Q;
 
-	    std::istringstream xml_action(params.fhparam.prop_param.fermact.xml);
-	    XMLReader action_reader(xml_action);
-	    Handle<FermionAction<T, P, Q>> action(TheFermionActionFactory::Instance().createObject(params.fhparam.prop_param.fermact.id, action_reader, params.fhparam.prop_param.fermact.path));
-	    Handle<FermState<T, P, Q>> action_state(action->createState(u));
+	    LalibeFermStateCache& ferm_cache = lalibeFermStateCache(params.fhparam.prop_param.fermact, params.named_obj.gauge_id, u);
+	    Handle<FermionAction<T, P, Q>> action = ferm_cache.action;
+	    Handle<FermState<T, P, Q>> action_state = ferm_cache.state;
 	    QDPIO::cout<<"Our action and fermion state are doing A-okay so far."<<std::endl;
 	    //Handle<SystemSolver<LatticeFermion>> solver = action->qprop(action_state, params.fhparam.prop_param.invParam);
 	    //Above is for a single fermion, but we want to loop over spin/color and solve for the full propagator.
@@ -264,56 +314,129 @@ namespace Chroma
 	    LatticePropagator fh_prop_solution;
 
             QDPIO::cout << "FH_PROPAGATOR: N_currents " << params.fhparam.currents.size() << std::endl;
-	    for(int current_index = 0; current_index < params.fhparam.currents.size(); current_index++)
+	    //quarkProp is what knows about the non-full spin types, so the batched path only does full props.
+	    bool batch_solve = params.fhparam.batch_solve;
+	    if (batch_solve && params.fhparam.prop_param.quarkSpinType != QUARK_SPIN_TYPE_FULL)
+	    {
+	      QDPIO::cout << "FH_PROPAGATOR: batch_solve needs a full quark spin type, solving one insertion at a time" << std::endl;
+	      batch_solve = false;
+	    }
+
+	    if (batch_solve)
 	    {
-	      std::string present_current = params.fhparam.currents[current_index];
-              QDPIO::cout << "FH_PROPAGATOR: current " << present_current << std::endl;
+	      //Every (current, momentum) insertion goes through the same solver on the same fermion state,
+	      //batch_insertions of them at a time, Nc*Ns sources each, in one multi-rhs call per group.
+	      Handle<SystemSolver<LatticeFermion>> solver = action->qprop(action_state, params.fhparam.prop_param.invParam);
+	      const int dilutions = Nc*Ns;
+	      const int num_insertions = params.fhparam.currents.size()*ft.numMom();
+	      const int batch = std::min(params.fhparam.batch_insertions, num_insertions);
 	      fh_prop_solution = zero;
-              // WE SHOULD MAKE THIS A FACTORY
-             Bilinear_Gamma(present_current, fh_prop_src, quark_propagator, u);
 
-	      //Momentum loop
-	      for(int mom = 0; mom < ft.numMom(); mom++)
+	      push(xml_out, "FH_Solves");
+	      for(int batch_start = 0; batch_start < num_insertions; batch_start += batch)
 	      {
+		const int batch_end = std::min(batch_start + batch, num_insertions);
+		multi1d<LatticeFermion> chi((batch_end - batch_start)*dilutions);
+		multi1d<LatticeFermion> psi((batch_end - batch_start)*dilutions);
+		//Insertion index runs over currents and momenta, momenta is inner most index, same as fh_prop_id.
+		int last_current = -1;
+		for(int insertion = batch_start; insertion < batch_end; insertion++)
+		{
+		  int current_index = insertion / ft.numMom();
+		  int mom = insertion % ft.numMom();
+		  if (current_index != last_current)
+		  {
+		    std::string present_current = params.fhparam.currents[current_index];
+		    QDPIO::cout << "FH_PROPAGATOR: current " << present_current << std::endl;
+		    // WE SHOULD MAKE THIS A FACTORY
+		    Bilinear_Gamma(present_current, fh_prop_src, quark_propagator, u);
+		    last_current = current_index;
+		  }
+		  multi1d<int> momenta = ft.numToMom(mom);
+		  QDPIO::cout << "Injecting momentum - px: "<<std::to_string(momenta[0])<<" py: "+std::to_string(momenta[1])<<" pz: "+std::to_string(momenta[2])<<std::endl;
+		  LatticePropagator phased_src = ft[mom]*fh_prop_src;
+		  const int offset = (insertion - batch_start)*dilutions;
+		  for(int color_source = 0; color_source < Nc; color_source++)
+		    for(int spin_source = 0; spin_source < Ns; spin_source++)
+		    {
+		      PropToFerm(phased_src, chi[offset + color_source*Ns + spin_source], color_source, spin_source);
+		      //The last finished solution is the guess, when asked for, otherwise start from zero like qprop.
+		      if (params.fhparam.initial_guess)
+			PropToFerm(fh_prop_solution, psi[offset + color_source*Ns + spin_source], color_source, spin_source);
+		      else
+			psi[offset + color_source*Ns + spin_source] = zero;
+		    }
+		}
 
-		multi1d<int> momenta = ft.numToMom(mom);
-		QDPIO::cout << "Injecting momentum - px: "<<std::to_string(momenta[0])<<" py: "+std::to_string(momenta[1])<<" pz: "+std::to_string(momenta[2])<<std::endl;
-		fh_prop_src = ft[mom]*fh_prop_src;
-	        //Now, we do the actual solve.
-		action->quarkProp(fh_prop_solution, xml_out, fh_prop_src, t0, j_decay, action_state,
-                params.fhparam.prop_param.invParam,
-                params.fhparam.prop_param.quarkSpinType,
-                params.fhparam.prop_param.obsvP, ncg_had);
-
-		push(xml_out,"Relaxation_Iterations");
-  	        write(xml_out, "ncg_had", ncg_had);
-  	        pop(xml_out);
+		//Now, we do the actual solve.
+		multi1d<SystemSolverResults_t> res = block_solve(*solver, psi, chi, true);
 
-  	        QDPIO::cout << "Writing propagator info, cause why not?" << std::endl;
-  	        XMLBufferWriter file_xml;
-  	        push(file_xml, "propagator");
-  	        write(file_xml, "id", uniqueId());  // NOTE: new ID form
-  	        pop(file_xml);
+		for(int insertion = batch_start; insertion < batch_end; insertion++)
+		{
+		  const int offset = (insertion - batch_start)*dilutions;
+		  fh_prop_solution = zero;
+		  spin_color_to_prop(psi, offset, fh_prop_solution);
+
+		  // Looping over currents and momenta, momenta is inner most index
+		  // current_id = flattened index running over both these indices
+		  std::string current_id = params.named_obj.fh_prop_id[insertion];
+		  multi1d<int> n_count(dilutions);
+		  multi1d<Real> resid(dilutions);
+		  for(int rhs = 0; rhs < dilutions; rhs++)
+		  {
+		    n_count[rhs] = res[offset + rhs].n_count;
+		    resid[rhs] = res[offset + rhs].resid;
+		    ncg_had += res[offset + rhs].n_count;
+		  }
+		  push(xml_out, "FH_Solve");
+		  write(xml_out, "fh_prop_id", current_id);
+		  write(xml_out, "n_count", n_count);
+		  write(xml_out, "resid", resid);
+		  pop(xml_out);
+
+		  store_fh_prop(current_id, fh_prop_solution, prop_record_xml, params.fhparam.prop_param);
+		}
+	      }
+	      pop(xml_out);
 
-  	        //If ths src is not from make source these thing is not going to work...
-  	        XMLBufferWriter record_xml;
-  	        MakeSourceProp_t  orig_header;
-  	        read(prop_record_xml, "/Propagator", orig_header);
-  	        Propagator_t  new_header;   // note, abandoning state_info
-  	        new_header.prop_header   = params.fhparam.prop_param;
-  	        new_header.source_header = orig_header.source_header;
-  	        new_header.gauge_header  = orig_header.gauge_header;
-  	        write(record_xml, "Propagator", new_header);
+	      push(xml_out,"Relaxation_Iterations");
+	      write(xml_out, "ncg_had", ncg_had);
+	      pop(xml_out);
+	    }
+	    else
+	    {
+	      for(int current_index = 0; current_index < params.fhparam.currents.size(); current_index++)
+	      {
+		std::string present_current = params.fhparam.currents[current_index];
+		QDPIO::cout << "FH_PROPAGATOR: current " << present_current << std::endl;
+		fh_prop_solution = zero;
+		// WE SHOULD MAKE THIS A FACTORY
+	       Bilinear_Gamma(present_current, fh_prop_src, quark_propagator, u);
+
+		//Momentum loop
+		for(int mom = 0; mom < ft.numMom(); mom++)
+		{
 
-  	        // Pass the propagator info to the Named Object Buffer.
-                // Looping over currents and momenta, momenta is inner most index
-                // current_id = flattened index running over both these indices
-  	        std::string current_id = params.named_obj.fh_prop_id[ft.numMom()*current_index + mom];
-  	        TheNamedObjMap::Instance().create<LatticePropagator>(current_id);
-  	        TheNamedObjMap::Instance().getData<LatticePropagator>(current_id) = fh_prop_solution;
-  	        TheNamedObjMap::Instance().get(current_id).setFileXML(file_xml);
-  	        TheNamedObjMap::Instance().get(current_id).setRecordXML(record_xml);
-  	        QDPIO::cout<<"YAAAY! We finished current: "<<current_id<<std::endl;
+		  multi1d<int> momenta = ft.numToMom(mom);
+		  QDPIO::cout << "Injecting momentum - px: "<<std::to_string(momenta[0])<<" py: "+std::to_string(momenta[1])<<" pz: "+std::to_string(momenta[2])<<std::endl;
+		  //Phase the unphased current-inserted source, not the one left over from the previous momentum.
+		  LatticePropagator phased_src = ft[mom]*fh_prop_src;
+		  //Now, we do the actual solve.
+		  action->quarkProp(fh_prop_solution, xml_out, phased_src, t0, j_decay, action_state,
+		  params.fhparam.prop_param.invParam,
+		  params.fhparam.prop_param.quarkSpinType,
+		  params.fhparam.prop_param.obsvP, ncg_had);
+
+		  push(xml_out,"Relaxation_Iterations");
+		  write(xml_out, "ncg_had", ncg_had);
+		  pop(xml_out);
+
+		  // Pass the propagator info to the Named Object Buffer.
+		  // Looping over currents and momenta, momenta is inner most index
+		  // current_id = flattened index running over both these indices
+		  std::string current_id = params.named_obj.fh_prop_id[ft.numMom()*current_index + mom];
+		  store_fh_prop(current_id, fh_prop_solution, prop_record_xml, params.fhparam.prop_param);
+		}
 	      }
 	    }
 	    snoop.stop();
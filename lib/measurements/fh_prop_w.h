@@ -50,6 +50,9 @@ namespace Chroma
 	multi1d<multi1d<int>> mom_list;       //list of momenta insertions, optional
 	multi2d<int> p_list;                  //momentum list the slow fourier transform needs
 	ChromaProp_t prop_param;              //params for next lin solve
+	bool batch_solve;                     //solve all insertions with one solver, in multi-rhs groups, optional
+	int batch_insertions;                 //number of (current, momentum) insertions per multi-rhs group, optional
+	bool initial_guess;                   //start each group from the previous group's solution, optional
       } fhparam ;
 
       struct NamedObject_t
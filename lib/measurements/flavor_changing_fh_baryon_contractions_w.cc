@@ -12,6 +12,7 @@
 #include "../contractions/proton_contractions_func_w.h"
 #include "meas/inline/abs_inline_measurement_factory.h"
 #include "../momentum/lalibe_sftmom.h"
+#include "../io/hdf5_writer_cache.h"
 #include "meas/inline/io/named_objmap.h"
 #include "io/qprop_io.h"
 
@@ -485,7 +486,7 @@ namespace Chroma
 
 #ifdef BUILD_HDF5
       //If we are writing with hdf5, the start up is done here.
-      HDF5Writer h5out(params.param.file_name);
+      HDF5Writer& h5out = lalibeHDF5Writer(params.param.file_name);
       //h5out.push(params.param.obj_path);
       HDF5Base::writemode wmode;
       wmode = HDF5Base::ate;
@@ -604,7 +605,6 @@ namespace Chroma
 
 #ifdef BUILD_HDF5
       h5out.cd("/");
-      h5out.close();
 #endif
 
       //pop(xml_out);
@@ -0,0 +1,112 @@
+/*! 
+ * Inline task to close the HDF5 files the writers keep open, so everything written so far is on disk.
+ */
+
+//Protect everything with a preprocessing directive.
+#ifdef BUILD_HDF5
+
+#include "meas/inline/abs_inline_measurement_factory.h"
+
+//LALIBE stuff
+#include "hdf5_flush.h"
+#include "../io/hdf5_writer_cache.h"
+
+namespace Chroma 
+{ 
+  namespace LalibeHDF5FlushEnv 
+  { 
+    namespace
+    {
+      AbsInlineMeasurement* createMeasurement(XMLReader& xml_in, 
+					      const std::string& path) 
+      {
+	return new InlineMeas(Params(xml_in, path));
+      }
+
+      //! Local registration flag
+      bool registered = false;
+
+      const std::string name = "HDF5_FLUSH";
+    }
+
+    //! Register all the factories
+    bool registerAll() 
+    {
+      bool success = true; 
+      if (! registered)
+      {
+	success &= TheInlineMeasurementFactory::Instance().registerObject(name, createMeasurement);
+
+	registered = true;
+      }
+      return success;
+    }
+
+
+    // Param stuff
+    Params::Params() { frequency = 0; }
+
+    Params::Params(XMLReader& xml_in, const std::string& path) 
+    {
+      try 
+      {
+	XMLReader paramtop(xml_in, path);
+
+	if (paramtop.count("Frequency") == 1)
+	  read(paramtop, "Frequency", frequency);
+	else
+	  frequency = 1;
+
+	if (paramtop.count("file_names") != 0)
+	  read(paramtop, "file_names", file_names);
+	else
+	  file_names.resize(0);
+      }
+      catch(const std::string& e) 
+      {
+	QDPIO::cerr << __func__ << ": Caught Exception reading XML: " << e << std::endl;
+	QDP_abort(1);
+      }
+    }
+
+
+    void
+    Params::writeXML(XMLWriter& xml_out, const std::string& path) 
+    {
+      push(xml_out, path);
+    
+      write(xml_out, "file_names", file_names);
+
+      pop(xml_out);
+    }
+
+
+    // Func
+    void 
+    InlineMeas::operator()(unsigned long update_no,
+			   XMLWriter& xml_out) 
+    {
+      START_CODE();
+
+      push(xml_out, "hdf5_flush");
+      write(xml_out, "update_no", update_no);
+
+      QDPIO::cout << name << ": closing open HDF5 files" << std::endl;
+      if (params.file_names.size() == 0)
+	lalibeHDF5CloseAll();
+      else
+	for (int f = 0; f < params.file_names.size(); f++)
+	  lalibeHDF5Close(params.file_names[f]);
+      write(xml_out, "file_names", params.file_names);
+
+      QDPIO::cout << name << ": ran successfully" << std::endl;
+      pop(xml_out);  
+
+      END_CODE();
+    } 
+
+  }
+
+}
+
+#endif
@@ -0,0 +1,53 @@
+/*! 
+ * Inline task to close the HDF5 files the writers keep open, so everything written so far is on disk.
+ */
+
+//Protect everything with a preprocessing directive.
+#ifdef BUILD_HDF5
+
+#ifndef __lalibe_hdf5_flush_h__
+#define __lalibe_hdf5_flush_h__
+
+#include "chromabase.h"
+#include "meas/inline/abs_inline_measurement.h"
+
+namespace Chroma 
+{ 
+  namespace LalibeHDF5FlushEnv 
+  {
+    bool registerAll();
+
+    //! Parameter structure
+    struct Params 
+    {
+      Params();
+      Params(XMLReader& xml_in, const std::string& path);
+      void writeXML(XMLWriter& xml_out, const std::string& path);
+
+      unsigned long frequency;
+
+      multi1d<std::string> file_names;   //files to close, all open files if empty or not given
+    };
+
+    class InlineMeas : public AbsInlineMeasurement 
+    {
+    public:
+      ~InlineMeas() {}
+      InlineMeas(const Params& p) : params(p) {}
+
+      unsigned long getFrequency(void) const {return params.frequency;}
+
+      void operator()(const unsigned long update_no,
+		      XMLWriter& xml_out); 
+
+    private:
+      Params params;
+    };
+
+  }
+
+}
+
+#endif
+
+#endif
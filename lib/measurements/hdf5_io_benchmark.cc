@@ -0,0 +1,204 @@
+/*! 
+ * Inline task timing HDF5 writes and reads of a propagator, to pick the HDF5Tuning of a machine.
+ * Writes are timed through close, reads follow the writes and are page cache bound.
+ */
+
+//Protect everything with a preprocessing directive.
+#ifdef BUILD_HDF5
+
+#include "meas/inline/abs_inline_measurement_factory.h"
+
+//LALIBE stuff
+#include "hdf5_io_benchmark.h"
+#include "../io/hdf5_writer_cache.h"
+
+#include <cstdio>
+
+namespace Chroma 
+{ 
+  namespace LalibeHDF5IOBenchmarkEnv 
+  { 
+    namespace
+    {
+      AbsInlineMeasurement* createMeasurement(XMLReader& xml_in, 
+					      const std::string& path) 
+      {
+	return new InlineMeas(Params(xml_in, path));
+      }
+
+      //! Local registration flag
+      bool registered = false;
+
+      const std::string name = "HDF5_IO_BENCHMARK";
+    }
+
+    //! Register all the factories
+    bool registerAll() 
+    {
+      bool success = true; 
+      if (! registered)
+      {
+	success &= TheInlineMeasurementFactory::Instance().registerObject(name, createMeasurement);
+
+	registered = true;
+      }
+      return success;
+    }
+
+
+    // Param stuff
+    Params::Params() { frequency = 0; repeats = 3; }
+
+    Params::Params(XMLReader& xml_in, const std::string& path) 
+    {
+      try 
+      {
+	XMLReader paramtop(xml_in, path);
+
+	if (paramtop.count("Frequency") == 1)
+	  read(paramtop, "Frequency", frequency);
+	else
+	  frequency = 1;
+
+	read(paramtop, "file_name", file_name);
+	if (paramtop.count("stripesizes") != 0)
+	  read(paramtop, "stripesizes", stripesizes);
+	else
+	{
+	  stripesizes.resize(1);
+	  stripesizes[0] = 1048576;
+	}
+	if (paramtop.count("repeats") != 0)
+	  read(paramtop, "repeats", repeats);
+	else
+	  repeats = 3;
+	if (repeats < 1)
+	{
+	  QDPIO::cerr << __func__ << ": repeats must be at least 1, got " << repeats << std::endl;
+	  QDP_abort(1);
+	}
+      }
+      catch(const std::string& e) 
+      {
+	QDPIO::cerr << __func__ << ": Caught Exception reading XML: " << e << std::endl;
+	QDP_abort(1);
+      }
+    }
+
+
+    void
+    Params::writeXML(XMLWriter& xml_out, const std::string& path) 
+    {
+      push(xml_out, path);
+    
+      write(xml_out, "file_name", file_name);
+      write(xml_out, "stripesizes", stripesizes);
+      write(xml_out, "repeats", repeats);
+
+      pop(xml_out);
+    }
+
+
+    // Func
+    void 
+    InlineMeas::operator()(unsigned long update_no,
+			   XMLWriter& xml_out) 
+    {
+      START_CODE();
+
+      push(xml_out, "hdf5_io_benchmark");
+      write(xml_out, "update_no", update_no);
+
+      QDPIO::cout << name << ": timing propagator writes and reads to " << params.file_name << std::endl;
+
+      //The file may have been written to earlier in the run, nothing should be left open on it.
+      lalibeHDF5Close(params.file_name);
+
+      //The test propagator is drawn without moving the run's random number state, so adding the
+      //benchmark to a deck does not change any later random source.
+      LatticePropagator prop;
+      Seed ran_seed;
+      QDP::RNG::savern(ran_seed);
+      gaussian(prop);
+      QDP::RNG::setrn(ran_seed);
+      LatticePropagator prop_in;
+      const double gb_per_rank = double(Layout::sitesOnNode())*Ns*Ns*Nc*Nc*2*sizeof(REAL)/1.0e9;
+      write(xml_out, "GB_per_rank", gb_per_rank);
+
+      push(xml_out, "Results");
+      for(int s = 0; s < params.stripesizes.size(); s++)
+      {
+	const int stripesize = params.stripesizes[s];
+	//Every repeat overwrites the same dataset, the file never holds more than one propagator per stripe size.
+	const std::string group = "/stripesize_"+std::to_string(stripesize);
+	const std::string dataset = group+"/prop";
+	StopWatch swatch;
+	double write_time = 0, read_time = 0;
+
+	//Each write is timed from open to close, so the time to flush the data out of the HDF5 and MPI-IO
+	//buffers is counted.
+	HDF5Base::writemode wmode = HDF5Base::trunc;
+	for(int r = 0; r < params.repeats; r++)
+	{
+	  swatch.reset();
+	  swatch.start();
+	  HDF5Writer h5out(params.file_name);
+	  h5out.set_stripesize(stripesize);
+	  h5out.push(group);
+	  h5out.write(dataset, prop, wmode);
+	  h5out.cd("/");
+	  h5out.close();
+	  swatch.stop();
+	  write_time += swatch.getTimeInSeconds();
+	}
+
+	//The reads come right after the writes on the same nodes, so they are mostly served from the page
+	//cache and are reported as such, they are not a measure of the filesystem.
+	HDF5Reader reader;
+	reader.open(params.file_name);
+	reader.set_stripesize(stripesize);
+	Double max_diff = zero;
+	for(int r = 0; r < params.repeats; r++)
+	{
+	  swatch.reset();
+	  swatch.start();
+	  reader.read(dataset, prop_in);
+	  swatch.stop();
+	  read_time += swatch.getTimeInSeconds();
+	  Double diff = sqrt(norm2(prop_in - prop)/norm2(prop));
+	  if (toDouble(diff) > toDouble(max_diff))
+	    max_diff = diff;
+	}
+	reader.close();
+
+	const double write_rate = gb_per_rank*params.repeats/write_time;
+	const double read_rate = gb_per_rank*params.repeats/read_time;
+	QDPIO::cout << name << ": stripesize " << stripesize << " write " << write_rate << " GB/s per rank, cached read "
+		    << read_rate << " GB/s per rank, max relative difference " << max_diff << std::endl;
+
+	push(xml_out, "elem");
+	write(xml_out, "stripesize", stripesize);
+	write(xml_out, "write_time", write_time);
+	write(xml_out, "cached_read_time", read_time);
+	write(xml_out, "write_GB_per_sec_per_rank", write_rate);
+	write(xml_out, "cached_read_GB_per_sec_per_rank", read_rate);
+	write(xml_out, "max_rel_diff", max_diff);
+	pop(xml_out);
+      }
+      pop(xml_out);
+
+      //The file is scratch, nothing in it is kept.
+      if (Layout::primaryNode())
+	std::remove(params.file_name.c_str());
+
+      QDPIO::cout << name << ": ran successfully" << std::endl;
+      pop(xml_out);  
+
+      END_CODE();
+    } 
+
+  }
+
+}
+
+#endif
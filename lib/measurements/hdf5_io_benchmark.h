@@ -0,0 +1,55 @@
+/*! 
+ * Inline task timing HDF5 writes and reads of a propagator, to pick the HDF5Tuning of a machine.
+ */
+
+//Protect everything with a preprocessing directive.
+#ifdef BUILD_HDF5
+
+#ifndef __lalibe_hdf5_io_benchmark_h__
+#define __lalibe_hdf5_io_benchmark_h__
+
+#include "chromabase.h"
+#include "meas/inline/abs_inline_measurement.h"
+
+namespace Chroma 
+{ 
+  namespace LalibeHDF5IOBenchmarkEnv 
+  {
+    bool registerAll();
+
+    //! Parameter structure
+    struct Params 
+    {
+      Params();
+      Params(XMLReader& xml_in, const std::string& path);
+      void writeXML(XMLWriter& xml_out, const std::string& path);
+
+      unsigned long frequency;
+
+      std::string file_name;          //scratch file the test propagators go to, overwritten and removed at the end
+      multi1d<int> stripesizes;       //stripe sizes to try, in bytes, 1048576 if not given
+      int repeats;                    //writes and reads timed per stripe size, 3 if not given
+    };
+
+    class InlineMeas : public AbsInlineMeasurement 
+    {
+    public:
+      ~InlineMeas() {}
+      InlineMeas(const Params& p) : params(p) {}
+
+      unsigned long getFrequency(void) const {return params.frequency;}
+
+      void operator()(const unsigned long update_no,
+		      XMLWriter& xml_out); 
+
+    private:
+      Params params;
+    };
+
+  }
+
+}
+
+#endif
+
+#endif
@@ -19,6 +19,8 @@
 
 //LALIBE stuff
 #include "hdf5_read_obj.h"
+#include "../io/hdf5_writer_cache.h"
+#include "../io/hdf5_precision.h"
 
 namespace Chroma 
 { 
@@ -59,11 +61,14 @@ namespace Chroma
 	  HDF5ReadLatProp(const Params& p) : params(p) {}
 
 	  void operator()() {
-	    LatticePropagator obj;
+	    //Read straight into the named object, there is no temporary to copy from afterwards.
+	    TheNamedObjMap::Instance().create<LatticePropagator>(params.named_obj.object_id);
+	    LatticePropagator& obj = TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.object_id);
 	    //XMLReader file_xml, record_xml;
 
 	    HDF5Reader reader;
 	    reader.open(params.file.file_name);
+	    reader.set_stripesize(params.tuning.stripesize);
 	    reader.cd(params.file.path);
 	    reader.read(params.file.obj_name,obj);
 	    std::string file;
@@ -94,8 +99,6 @@ namespace Chroma
 	    XMLReader  file_xml(file_xml_stream);
 	    XMLReader  record_xml(record_xml_stream);
 
-	    TheNamedObjMap::Instance().create<LatticePropagator>(params.named_obj.object_id);
-	    TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.object_id) = obj;
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setFileXML(file_xml);
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setRecordXML(record_xml);
 	  }
@@ -116,13 +119,15 @@ namespace Chroma
 	  HDF5ReadLatPropF(const Params& p) : params(p) {}
 
 	  void operator()() {
-	    LatticePropagatorF obj;
+	    TheNamedObjMap::Instance().create<LatticePropagator>(params.named_obj.object_id);
+	    LatticePropagator& obj = TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.object_id);
 	    //XMLReader file_xml, record_xml;
 	   
 	    HDF5Reader reader;
 	    reader.open(params.file.file_name);
+	    reader.set_stripesize(params.tuning.stripesize);
 	    reader.cd(params.file.path);
-	    reader.read(params.file.obj_name,obj);
+	    LalibeHDF5Precision<LatticePropagatorF, LatticePropagator>::read(reader, params.file.obj_name, obj);
 	    std::string file;
 	    std::string record;
 	    reader.readAttribute(params.file.obj_name, "file_xml", file);
@@ -151,8 +156,6 @@ namespace Chroma
 	    XMLReader  file_xml(file_xml_stream);
 	    XMLReader  record_xml(record_xml_stream);
 
-	    TheNamedObjMap::Instance().create<LatticePropagator>(params.named_obj.object_id);
-	    TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.object_id) = obj;
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setFileXML(file_xml);
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setRecordXML(record_xml);
 
@@ -174,13 +177,15 @@ namespace Chroma
 	  HDF5ReadLatPropD(const Params& p) : params(p) {}
 
 	  void operator()() {
-	    LatticePropagatorD obj;
+	    TheNamedObjMap::Instance().create<LatticePropagator>(params.named_obj.object_id);
+	    LatticePropagator& obj = TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.object_id);
 	    //XMLReader file_xml, record_xml;
 	   
 	    HDF5Reader reader;
 	    reader.open(params.file.file_name);
+	    reader.set_stripesize(params.tuning.stripesize);
 	    reader.cd(params.file.path);
-	    reader.read(params.file.obj_name,obj);
+	    LalibeHDF5Precision<LatticePropagatorD, LatticePropagator>::read(reader, params.file.obj_name, obj);
 	    std::string file;
 	    std::string record;
 	    reader.readAttribute(params.file.obj_name, "file_xml", file);
@@ -209,8 +214,6 @@ namespace Chroma
 	    XMLReader  file_xml(file_xml_stream);
 	    XMLReader  record_xml(record_xml_stream);
 
-	    TheNamedObjMap::Instance().create<LatticePropagator>(params.named_obj.object_id);
-	    TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.object_id) = obj;
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setFileXML(file_xml);
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setRecordXML(record_xml);
 
@@ -231,10 +234,12 @@ namespace Chroma
 	  HDF5ReadLatUpperProp(const Params& p) : params(p) {}
 
 	  void operator()() {
-	    LatticePropagator obj;
+	    TheNamedObjMap::Instance().create<LatticePropagator>(params.named_obj.object_id);
+	    LatticePropagator& obj = TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.object_id);
 
 	    HDF5Reader reader;
 	    reader.open(params.file.file_name);
+	    reader.set_stripesize(params.tuning.stripesize);
 	    //reader.cd(params.file.path);
 	    //We need to cd to the full path specified, since multiple fermions are stored inside.
 	    std::string propagator_path=params.file.path+"/"+params.file.obj_name;
@@ -267,8 +272,6 @@ namespace Chroma
 	    XMLReader  file_xml(file_xml_stream);
 	    XMLReader  record_xml(record_xml_stream);
 
-	    TheNamedObjMap::Instance().create<LatticePropagator>(params.named_obj.object_id);
-	    TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.object_id) = obj;
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setFileXML(file_xml);
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setRecordXML(record_xml);
 	  }
@@ -288,10 +291,12 @@ namespace Chroma
 	  HDF5ReadLatUpperPropF(const Params& p) : params(p) {}
 
 	  void operator()() {
-	    LatticePropagatorF obj;
+	    TheNamedObjMap::Instance().create<LatticePropagator>(params.named_obj.object_id);
+	    LatticePropagator& obj = TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.object_id);
 
 	    HDF5Reader reader;
 	    reader.open(params.file.file_name);
+	    reader.set_stripesize(params.tuning.stripesize);
 	    //reader.cd(params.file.path);
 	    //We need to cd to the full path specified, since multiple fermions are stored inside.
 	    std::string propagator_path=params.file.path+"/"+params.file.obj_name;
@@ -303,11 +308,13 @@ namespace Chroma
 	      for(int spin_source = Ns/2; spin_source < Ns; ++spin_source) 
 	      { 
 		int original_spin = spin_source - Ns/2;
-		LatticeFermionF psi;
+		LatticeFermionF psi_file;
+		LatticeFermion psi;
 	
 		QDPIO::cout<<"Reading color: "<<color_source<<" spin: "<<original_spin<<" and copying into spin "<<spin_source<<std::endl;
 		fermion_path = "color_"+std::to_string(color_source)+"_spin_"+std::to_string(original_spin);
-		reader.read(fermion_path,psi);
+		reader.read(fermion_path,psi_file);
+		psi = psi_file;
 		FermToProp(psi, obj, color_source, original_spin);
 		FermToProp(LatticeFermion(-psi), obj, color_source, spin_source);
 	      }
@@ -324,8 +331,6 @@ namespace Chroma
 	    XMLReader  file_xml(file_xml_stream);
 	    XMLReader  record_xml(record_xml_stream);
 
-	    TheNamedObjMap::Instance().create<LatticePropagator>(params.named_obj.object_id);
-	    TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.object_id) = obj;
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setFileXML(file_xml);
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setRecordXML(record_xml);
 	  }
@@ -345,10 +350,12 @@ namespace Chroma
 	  HDF5ReadLatUpperPropD(const Params& p) : params(p) {}
 
 	  void operator()() {
-	    LatticePropagatorD obj;
+	    TheNamedObjMap::Instance().create<LatticePropagator>(params.named_obj.object_id);
+	    LatticePropagator& obj = TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.object_id);
 
 	    HDF5Reader reader;
 	    reader.open(params.file.file_name);
+	    reader.set_stripesize(params.tuning.stripesize);
 	    //reader.cd(params.file.path);
 	    //We need to cd to the full path specified, since multiple fermions are stored inside.
 	    std::string propagator_path=params.file.path+"/"+params.file.obj_name;
@@ -360,11 +367,13 @@ namespace Chroma
 	      for(int spin_source = Ns/2; spin_source < Ns; ++spin_source) 
 	      { 
 		int original_spin = spin_source - Ns/2;
-		LatticeFermionD psi;
+		LatticeFermionD psi_file;
+		LatticeFermion psi;
 	
 		QDPIO::cout<<"Reading color: "<<color_source<<" spin: "<<original_spin<<" and copying into spin "<<spin_source<<std::endl;
 		fermion_path = "color_"+std::to_string(color_source)+"_spin_"+std::to_string(original_spin);
-		reader.read(fermion_path,psi);
+		reader.read(fermion_path,psi_file);
+		psi = psi_file;
 		FermToProp(psi, obj, color_source, original_spin);
 		FermToProp(LatticeFermion(-psi), obj, color_source, spin_source);
 	      }
@@ -381,8 +390,6 @@ namespace Chroma
 	    XMLReader  file_xml(file_xml_stream);
 	    XMLReader  record_xml(record_xml_stream);
 
-	    TheNamedObjMap::Instance().create<LatticePropagator>(params.named_obj.object_id);
-	    TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.object_id) = obj;
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setFileXML(file_xml);
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setRecordXML(record_xml);
 	  }
@@ -402,10 +409,12 @@ namespace Chroma
 	  HDF5ReadLatLowerProp(const Params& p) : params(p) {}
 
 	  void operator()() {
-	    LatticePropagator obj;
+	    TheNamedObjMap::Instance().create<LatticePropagator>(params.named_obj.object_id);
+	    LatticePropagator& obj = TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.object_id);
 
 	    HDF5Reader reader;
 	    reader.open(params.file.file_name);
+	    reader.set_stripesize(params.tuning.stripesize);
 	    //reader.cd(params.file.path);
 	    //We need to cd to the full path specified, since multiple fermions are stored inside.
 	    std::string propagator_path=params.file.path+"/"+params.file.obj_name;
@@ -438,8 +447,6 @@ namespace Chroma
 	    XMLReader  file_xml(file_xml_stream);
 	    XMLReader  record_xml(record_xml_stream);
 
-	    TheNamedObjMap::Instance().create<LatticePropagator>(params.named_obj.object_id);
-	    TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.object_id) = obj;
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setFileXML(file_xml);
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setRecordXML(record_xml);
 	  }
@@ -459,10 +466,12 @@ namespace Chroma
 	  HDF5ReadLatLowerPropF(const Params& p) : params(p) {}
 
 	  void operator()() {
-	    LatticePropagatorF obj;
+	    TheNamedObjMap::Instance().create<LatticePropagator>(params.named_obj.object_id);
+	    LatticePropagator& obj = TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.object_id);
 
 	    HDF5Reader reader;
 	    reader.open(params.file.file_name);
+	    reader.set_stripesize(params.tuning.stripesize);
 	    //reader.cd(params.file.path);
 	    //We need to cd to the full path specified, since multiple fermions are stored inside.
 	    std::string propagator_path=params.file.path+"/"+params.file.obj_name;
@@ -474,11 +483,13 @@ namespace Chroma
 	      for(int spin_source = 0; spin_source < Ns/2; ++spin_source) 
 	      { 
 		int original_spin = spin_source + Ns/2;
-		LatticeFermionF psi;
+		LatticeFermionF psi_file;
+		LatticeFermion psi;
 	
 		QDPIO::cout<<"Reading color: "<<color_source<<" spin: "<<original_spin<<" and copying into spin "<<spin_source<<std::endl;
 		fermion_path = "color_"+std::to_string(color_source)+"_spin_"+std::to_string(original_spin);
-		reader.read(fermion_path,psi);
+		reader.read(fermion_path,psi_file);
+		psi = psi_file;
 		FermToProp(psi, obj, color_source, original_spin);
 		FermToProp(psi, obj, color_source, spin_source);
 	      }
@@ -495,8 +506,6 @@ namespace Chroma
 	    XMLReader  file_xml(file_xml_stream);
 	    XMLReader  record_xml(record_xml_stream);
 
-	    TheNamedObjMap::Instance().create<LatticePropagator>(params.named_obj.object_id);
-	    TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.object_id) = obj;
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setFileXML(file_xml);
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setRecordXML(record_xml);
 	  }
@@ -516,10 +525,12 @@ namespace Chroma
 	  HDF5ReadLatLowerPropD(const Params& p) : params(p) {}
 
 	  void operator()() {
-	    LatticePropagatorD obj;
+	    TheNamedObjMap::Instance().create<LatticePropagator>(params.named_obj.object_id);
+	    LatticePropagator& obj = TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.object_id);
 
 	    HDF5Reader reader;
 	    reader.open(params.file.file_name);
+	    reader.set_stripesize(params.tuning.stripesize);
 	    //reader.cd(params.file.path);
 	    //We need to cd to the full path specified, since multiple fermions are stored inside.
 	    std::string propagator_path=params.file.path+"/"+params.file.obj_name;
@@ -531,11 +542,13 @@ namespace Chroma
 	      for(int spin_source = 0; spin_source < Ns/2; ++spin_source) 
 	      { 
 		int original_spin = spin_source + Ns/2;
-		LatticeFermionD psi;
+		LatticeFermionD psi_file;
+		LatticeFermion psi;
 	
 		QDPIO::cout<<"Reading color: "<<color_source<<" spin: "<<original_spin<<" and copying into spin "<<spin_source<<std::endl;
 		fermion_path = "color_"+std::to_string(color_source)+"_spin_"+std::to_string(original_spin);
-		reader.read(fermion_path,psi);
+		reader.read(fermion_path,psi_file);
+		psi = psi_file;
 		FermToProp(psi, obj, color_source, original_spin);
 		FermToProp(psi, obj, color_source, spin_source);
 	      }
@@ -552,8 +565,6 @@ namespace Chroma
 	    XMLReader  file_xml(file_xml_stream);
 	    XMLReader  record_xml(record_xml_stream);
 
-	    TheNamedObjMap::Instance().create<LatticePropagator>(params.named_obj.object_id);
-	    TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.object_id) = obj;
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setFileXML(file_xml);
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setRecordXML(record_xml);
 	  }
@@ -575,11 +586,13 @@ namespace Chroma
 	  HDF5ReadStagLatProp(const Params& p) : params(p) {}
 
 	  void operator()() {
-	    LatticeStaggeredPropagator obj;
+	    TheNamedObjMap::Instance().create<LatticeStaggeredPropagator>(params.named_obj.object_id);
+	    LatticeStaggeredPropagator& obj = TheNamedObjMap::Instance().getData<LatticeStaggeredPropagator>(params.named_obj.object_id);
 	    //XMLReader file_xml, record_xml;
 	   
 	    HDF5Reader reader;
 	    reader.open(params.file.file_name);
+	    reader.set_stripesize(params.tuning.stripesize);
 	    reader.cd(params.file.path);
 	    reader.read(params.file.obj_name,obj);
 	    std::string file;
@@ -610,8 +623,6 @@ namespace Chroma
 	    XMLReader  file_xml(file_xml_stream);
 	    XMLReader  record_xml(record_xml_stream);
 
-	    TheNamedObjMap::Instance().create<LatticeStaggeredPropagator>(params.named_obj.object_id);
-	    TheNamedObjMap::Instance().getData<LatticeStaggeredPropagator>(params.named_obj.object_id) = obj;
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setFileXML(file_xml);
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setRecordXML(record_xml);
 
@@ -634,13 +645,15 @@ namespace Chroma
 	  HDF5ReadStagLatPropF(const Params& p) : params(p) {}
 
 	  void operator()() {
-	    LatticeStaggeredPropagatorF obj;
+	    TheNamedObjMap::Instance().create<LatticeStaggeredPropagator>(params.named_obj.object_id);
+	    LatticeStaggeredPropagator& obj = TheNamedObjMap::Instance().getData<LatticeStaggeredPropagator>(params.named_obj.object_id);
 	    //XMLReader file_xml, record_xml;
 	   
 	    HDF5Reader reader;
 	    reader.open(params.file.file_name);
+	    reader.set_stripesize(params.tuning.stripesize);
 	    reader.cd(params.file.path);
-	    reader.read(params.file.obj_name,obj);
+	    LalibeHDF5Precision<LatticeStaggeredPropagatorF, LatticeStaggeredPropagator>::read(reader, params.file.obj_name, obj);
 	    std::string file;
 	    std::string record;
 	    reader.readAttribute(params.file.obj_name, "file_xml", file);
@@ -669,8 +682,6 @@ namespace Chroma
 	    XMLReader  file_xml(file_xml_stream);
 	    XMLReader  record_xml(record_xml_stream);
 
-	    TheNamedObjMap::Instance().create<LatticeStaggeredPropagator>(params.named_obj.object_id);
-	    TheNamedObjMap::Instance().getData<LatticeStaggeredPropagator>(params.named_obj.object_id) = obj;
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setFileXML(file_xml);
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setRecordXML(record_xml);
 
@@ -691,13 +702,15 @@ namespace Chroma
 	  HDF5ReadStagLatPropD(const Params& p) : params(p) {}
 
 	  void operator()() {
-	    LatticeStaggeredPropagatorD obj;
+	    TheNamedObjMap::Instance().create<LatticeStaggeredPropagator>(params.named_obj.object_id);
+	    LatticeStaggeredPropagator& obj = TheNamedObjMap::Instance().getData<LatticeStaggeredPropagator>(params.named_obj.object_id);
 	    //XMLReader file_xml, record_xml;
 	   
 	    HDF5Reader reader;
 	    reader.open(params.file.file_name);
+	    reader.set_stripesize(params.tuning.stripesize);
 	    reader.cd(params.file.path);
-	    reader.read(params.file.obj_name,obj);
+	    LalibeHDF5Precision<LatticeStaggeredPropagatorD, LatticeStaggeredPropagator>::read(reader, params.file.obj_name, obj);
 	    std::string file;
 	    std::string record;
 	    reader.readAttribute(params.file.obj_name, "file_xml", file);
@@ -726,8 +739,6 @@ namespace Chroma
 	    XMLReader  file_xml(file_xml_stream);
 	    XMLReader  record_xml(record_xml_stream);
 
-	    TheNamedObjMap::Instance().create<LatticeStaggeredPropagator>(params.named_obj.object_id);
-	    TheNamedObjMap::Instance().getData<LatticeStaggeredPropagator>(params.named_obj.object_id) = obj;
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setFileXML(file_xml);
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setRecordXML(record_xml);
 
@@ -751,11 +762,13 @@ namespace Chroma
 
 	  //! Read a propagator
 	  void operator()() {
-	    LatticeFermion obj;
+	    TheNamedObjMap::Instance().create<LatticeFermion>(params.named_obj.object_id);
+	    LatticeFermion& obj = TheNamedObjMap::Instance().getData<LatticeFermion>(params.named_obj.object_id);
 	    //XMLReader file_xml, record_xml;
 	   
 	    HDF5Reader reader;
 	    reader.open(params.file.file_name);
+	    reader.set_stripesize(params.tuning.stripesize);
 	    reader.cd(params.file.path);
 	    reader.read(params.file.obj_name,obj);
 	    std::string file;
@@ -786,8 +799,6 @@ namespace Chroma
 	    XMLReader  file_xml(file_xml_stream);
 	    XMLReader  record_xml(record_xml_stream);
 
-	    TheNamedObjMap::Instance().create<LatticeFermion>(params.named_obj.object_id);
-	    TheNamedObjMap::Instance().getData<LatticeFermion>(params.named_obj.object_id) = obj;
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setFileXML(file_xml);
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setRecordXML(record_xml);
 
@@ -810,11 +821,13 @@ namespace Chroma
 	  HDF5ReadArrayLatColMat(const Params& p) : params(p) {}
 
 	  void operator()() {
-	    multi1d<LatticeColorMatrix> obj;
+	    TheNamedObjMap::Instance().create<multi1d<LatticeColorMatrix>>(params.named_obj.object_id);
+	    multi1d<LatticeColorMatrix>& obj = TheNamedObjMap::Instance().getData<multi1d<LatticeColorMatrix>>(params.named_obj.object_id);
 	    //XMLReader file_xml, record_xml;
 	   
 	    HDF5Reader reader;
 	    reader.open(params.file.file_name);
+	    reader.set_stripesize(params.tuning.stripesize);
 	    reader.cd(params.file.path);
 	    //This needs to be fixed.
 	    reader.read(params.file.obj_name,obj);
@@ -846,8 +859,6 @@ namespace Chroma
 	    XMLReader  file_xml(file_xml_stream);
 	    XMLReader  record_xml(record_xml_stream);
 
-	    TheNamedObjMap::Instance().create<multi1d<LatticeColorMatrix>>(params.named_obj.object_id);
-	    TheNamedObjMap::Instance().getData<multi1d<LatticeColorMatrix>>(params.named_obj.object_id) = obj;
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setFileXML(file_xml);
 	    TheNamedObjMap::Instance().get(params.named_obj.object_id).setRecordXML(record_xml);
 
@@ -874,6 +885,7 @@ namespace Chroma
 	   
 	    HDF5Reader reader;
 	    reader.open(params.file.file_name);
+	    reader.set_stripesize(params.tuning.stripesize);
 	    reader.cd(params.file.path);
 	    //This needs to be fixed.
 	    //reader.read(params.file.obj_name,obj);
@@ -933,6 +945,7 @@ namespace Chroma
 	   
 	    HDF5Reader reader;
 	    reader.open(params.file.file_name);
+	    reader.set_stripesize(params.tuning.stripesize);
 	    reader.cd(params.file.path);
 	    //This needs to be fixed.
 	    //reader.read(params.file.obj_name,obj);
@@ -1112,6 +1125,9 @@ namespace Chroma
 	read(paramtop, "NamedObject", named_obj);
 
 	read(paramtop, "File", file);
+
+	if (paramtop.count("HDF5Tuning") == 1)
+	  read(paramtop, "HDF5Tuning", tuning);
       }
       catch(const std::string& e) 
       {
@@ -1143,6 +1159,9 @@ namespace Chroma
 	  HDF5ReadObjectEnv::TheHDF5ReadObjectFactory::Instance().createObject(params.named_obj.object_type,
 									     params));
 
+	// A file written earlier in this run may still be open, close it so the reader sees everything.
+	lalibeHDF5Close(params.file.file_name);
+
 	// Actually do the reading
 	swatch.start();
 
@@ -13,6 +13,9 @@
 #include "meas/inline/abs_inline_measurement.h"
 #include "io/xml_group_reader.h"
 
+//LALIBE stuff
+#include "../io/hdf5_tuning.h"
+
 namespace Chroma 
 { 
   /*! \ingroup inlineio */
@@ -43,6 +46,7 @@ namespace Chroma
       };
 
       File_t file;
+      LalibeHDF5Tuning tuning;      //optional HDF5Tuning block
       NamedObject_t named_obj;
       GroupXML_t    named_obj_xml;  /*!< Holds standard named objects */
     };
@@ -60,6 +60,8 @@ namespace Chroma
       {
 	swatch.reset();
 
+	if (params.tuned)
+	  lalibeSetHDF5Tuning(params.file.file_name, params.tuning);
 	// Calling the hdf5 writer generically.
 	LalibeHDF5WriteNamedObjEnv::InlineMeas hdf5_writer(params);
 	hdf5_writer(update_no, xml_out);
@@ -15,6 +15,7 @@
 //LALIBE stuff
 #include "hdf5_write_obj.h"
 #include "../io/hdf5_write_obj_funcmap.h"
+#include "../io/hdf5_output_queue.h"
 
 namespace Chroma 
 { 
@@ -100,7 +101,7 @@ namespace Chroma
 
 
     // Param stuff
-    Params::Params() { frequency = 0; }
+    Params::Params() { frequency = 0; tuned = false; staged = false; max_staged_mb = 0; }
 
     Params::Params(XMLReader& xml_in, const std::string& path) 
     {
@@ -118,6 +119,19 @@ namespace Chroma
 
 	// Read in the destination
 	read(paramtop, "File", file);
+
+	tuned = (paramtop.count("HDF5Tuning") == 1);
+	if (tuned)
+	  read(paramtop, "HDF5Tuning", tuning);
+
+	if (paramtop.count("staged") == 1)
+	  read(paramtop, "staged", staged);
+	else
+	  staged = false;
+	if (paramtop.count("max_staged_mb") == 1)
+	  read(paramtop, "max_staged_mb", max_staged_mb);
+	else
+	  max_staged_mb = 0;
       }
       catch(const std::string& e) 
       {
@@ -138,6 +152,12 @@ namespace Chroma
       // Write out the destination
       write(xml_out, "File", file);
 
+      if (tuned)
+	write(xml_out, "HDF5Tuning", tuning);
+
+      write(xml_out, "staged", staged);
+      write(xml_out, "max_staged_mb", max_staged_mb);
+
       pop(xml_out);
     }
 
@@ -176,14 +196,28 @@ namespace Chroma
 	else
 	  QDPIO::cerr << __func__ << ": The writemode you have selected doesn't exist. Try either ate or trunc." << std::endl;
 	  QDP_abort(1);*/
-	HDF5WriteObjCallMapEnv::TheHDF5WriteObjFuncMap::Instance().callFunction(params.named_obj.object_type,
-									      params.named_obj.object_id,
-									      params.file.file_name,
-									      params.file.obj_name,
-									      params.file.path, wmode);
+	if (params.tuned)
+	  lalibeSetHDF5Tuning(params.file.file_name, params.tuning);
+	if (params.staged)
+	{
+	  // A copy is written when the file is next flushed, the object itself is free to change
+	  LalibeStagedWrite staged;
+	  staged.object_id = params.named_obj.object_id;
+	  staged.object_type = params.named_obj.object_type;
+	  staged.file_name = params.file.file_name;
+	  staged.path = params.file.path;
+	  staged.obj_name = params.file.obj_name;
+	  lalibeStageHDF5Write(staged, params.max_staged_mb);
+	}
+	else
+	  HDF5WriteObjCallMapEnv::TheHDF5WriteObjFuncMap::Instance().callFunction(params.named_obj.object_type,
+										params.named_obj.object_id,
+										params.file.file_name,
+										params.file.obj_name,
+										params.file.path, wmode);
 	swatch.stop();
 
-	QDPIO::cout << "Object successfully written: time= " 
+	QDPIO::cout << (params.staged ? "Object successfully staged: time= " : "Object successfully written: time= ")
 		    << swatch.getTimeInSeconds() 
 		    << " secs" << std::endl;
       }
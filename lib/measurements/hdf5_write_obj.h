@@ -14,6 +14,7 @@
 #include "chromabase.h"
 #include "meas/inline/abs_inline_measurement.h"
 #include "io/qprop_io.h"
+#include "../io/hdf5_tuning.h"
 
 namespace Chroma 
 { 
@@ -45,6 +46,11 @@ namespace Chroma
 	std::string   obj_name;
 	//std::string   enum_wmode;
       } file;
+
+      bool tuned;                  //an HDF5Tuning block was given
+      LalibeHDF5Tuning tuning;     //applied to file.file_name for this and later writes
+      bool staged;                 //copy the object now and write it when the file is flushed, optional
+      double max_staged_mb;        //per node MB of staged copies before the oldest are written, <= 0 is no limit
     };
 
     //! Inline writing of memory objects
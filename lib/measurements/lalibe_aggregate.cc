@@ -26,6 +26,8 @@
 #include "hdf5_read_obj.h"
 #include "hdf5_write_obj.h"
 #include "hdf5_write_erase_obj.h"
+#include "hdf5_flush.h"
+#include "hdf5_io_benchmark.h"
 #endif
 
 namespace Chroma
@@ -72,6 +74,8 @@ namespace Chroma
 	success &= LalibeHDF5ReadNamedObjEnv::registerAll();
 	success &= LalibeHDF5WriteNamedObjEnv::registerAll();
 	success &= LalibeHDF5WriteEraseNamedObjEnv::registerAll();
+	success &= LalibeHDF5FlushEnv::registerAll();
+	success &= LalibeHDF5IOBenchmarkEnv::registerAll();
 #endif
 
 	registered = true;
@@ -15,6 +15,7 @@
 //We are using lalibe's fft.
 #include "util/info/proginfo.h"
 #include "../matrix_elements/lalibe_formfac_w.h"
+#include "../io/hdf5_writer_cache.h"
 #include "io/lalibe_qprop_io.h"
 
 #include "meas/inline/io/named_objmap.h"
@@ -170,6 +171,27 @@ namespace Chroma
 	param.p2_max = 0;
     }
     read(paramtop, "currents", param.currents);
+    if (paramtop.count("t_range") != 0)
+    {
+      read(paramtop, "t_range" ,param.t_range);
+      if (param.t_range.size() != 2 || param.t_range[1] < param.t_range[0])
+      {
+	QDPIO::cerr<<"t_range must be two time slices t_min t_max (relative to the source) with t_min <= t_max"<<std::endl;
+	QDP_abort(1);
+      }
+      param.use_t_range = true;
+      QDPIO::cout<<"Only contracting time slices "<<param.t_range[0]<<" to "<<param.t_range[1]<<" relative to the source"<<std::endl;
+    }
+    else
+      param.use_t_range = false;
+    if (paramtop.count("precision") != 0)
+    {
+      read(paramtop, "precision" ,param.precision);
+      lalibePrecisionFromString(param.precision);
+      QDPIO::cout<<"Contraction precision set to "<<param.precision<<std::endl;
+    }
+    else
+      param.precision = "double";
 
   }
 
@@ -191,6 +213,9 @@ namespace Chroma
     else
       write(xml, "mom_list" ,param.mom_list);
    write(xml, "currents", param.currents);
+    if(param.use_t_range == true)
+      write(xml, "t_range", param.t_range);
+    write(xml, "precision", param.precision);
 
     pop(xml);
   }
@@ -375,15 +400,16 @@ namespace Chroma
     // Read the quark propagator and extract headers
     //
     XMLReader prop_file_xml, prop_record_xml;
-    LatticePropagator quark_propagator;
+    //The propagators are used straight from the named object map, the task keeps no copies of them.
+    const LatticePropagator* quark_ptr = 0;
     ChromaProp_t prop_header;
     PropSourceConst_t source_header;
     QDPIO::cout << "Attempt to parse forward propagator" << std::endl;
     try
     {
       // Snarf the forward prop
-      quark_propagator =
-	TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.prop_id);
+      quark_ptr =
+	&TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.prop_id);
 
       // Snarf the source info. This is will throw if the source_id is not there
       TheNamedObjMap::Instance().get(params.named_obj.prop_id).getFileXML(prop_file_xml);
@@ -413,6 +439,7 @@ namespace Chroma
       QDP_abort(1);
     }
     QDPIO::cout << "Forward propagator successfully parsed" << std::endl;
+    const LatticePropagator& quark_propagator = *quark_ptr;
 
     // Derived from input prop
     multi1d<int> t_srce = source_header.getTSrce() ;
@@ -458,7 +485,7 @@ namespace Chroma
 
       // Read the sequential propagator
       // Read the quark propagator and extract headers
-      LatticePropagator seq_quark_prop;
+      const LatticePropagator* seq_ptr = 0;
       LalibeSeqSource_t seqsource_header;
       QDPIO::cout << "Attempt to parse sequential propagator" << std::endl;
       //This ID will persist beyond the try scope, but won't be null either way.
@@ -472,8 +499,8 @@ namespace Chroma
 	//The / has already been included to make life easier for the h5 writer.
 
 	// Snarf the backward prop
-	seq_quark_prop =
-	  TheNamedObjMap::Instance().getData<LatticePropagator>(seqprop_id);
+	seq_ptr =
+	  &TheNamedObjMap::Instance().getData<LatticePropagator>(seqprop_id);
 
 	// Snarf the source info. This is will throw if the source_id is not there
 	XMLReader seqprop_file_xml, seqprop_record_xml;
@@ -523,6 +550,7 @@ namespace Chroma
 	QDP_abort(1);
       }
       QDPIO::cout << "Sequential propagator successfully parsed" << std::endl;
+      const LatticePropagator& seq_quark_prop = *seq_ptr;
 
       // Sanity check - write out the norm2 of the forward prop in the j_decay direction
       // Use this for any possible verification
@@ -563,7 +591,7 @@ namespace Chroma
 
 #ifdef BUILD_HDF5
       //If we are writing with hdf5, the start up is done here.
-      HDF5Writer h5out(params.param.file_name);
+      HDF5Writer& h5out = lalibeHDF5Writer(params.param.file_name);
       //h5out.push(params.param.obj_path);
       HDF5Base::writemode wmode;
       wmode = HDF5Base::ate;
@@ -572,6 +600,9 @@ namespace Chroma
       // Now the 3pt contractions
       LalibeSftMom phases = params.param.is_mom_max ? LalibeSftMom(params.param.p2_max, t_srce, false, j_decay)
           : LalibeSftMom(params.param.p_list, t_srce, j_decay);
+      //Only the time slices between source and sink are needed for a fixed t_sep analysis.
+      if(params.param.use_t_range)
+	phases.setTimeWindow(t_source + params.param.t_range[0], params.param.t_range[1] - params.param.t_range[0] + 1);
       FormFac(bar3pt.bar.seqsrc[seq_src_ctr].formFacs,
 	      u, quark_propagator, seq_quark_prop, gamma_insertion,
 	      phases,
@@ -584,7 +615,8 @@ namespace Chroma
 	      h5out,
 	      wmode,
 #endif
-	      t_source);
+	      t_source,
+	      lalibePrecisionFromString(params.param.precision));
 
       pop(xml_seq_src);   // elem
     } // end loop over sequential sources
@@ -41,6 +41,9 @@ namespace Chroma
       int p2_max;                           //max of momentum transfer squared, optional
       multi1d<multi1d<int>> mom_list;       //list of momenta insertions, optional
       multi2d<int> p_list;                  //momentum list the slow fourier transform needs
+      bool use_t_range;                     //restrict contractions and FTs to a window of time slices, optional
+      multi1d<int> t_range;                 //[t_min, t_max] of that window relative to the source time
+      std::string precision;                //"double" (default), "single" or "validate" contraction precision
 #ifdef BUILD_HDF5
       std::string file_name;
       std::string obj_path;
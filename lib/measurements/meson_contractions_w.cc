@@ -14,6 +14,7 @@
 #include "../contractions/meson_contractions_func_w.h"
 #include "meas/inline/abs_inline_measurement_factory.h"
 #include "../momentum/lalibe_sftmom.h"
+#include "../io/hdf5_writer_cache.h"
 #include "meas/inline/io/named_objmap.h"
 #include "io/qprop_io.h"
 
@@ -54,6 +55,13 @@ namespace Chroma
       read(paramtop, "h5_file_name", par.file_name);
       read(paramtop, "obj_path", par.obj_path);
       QDPIO::cout<<"HDF5 found, writing to"<<par.file_name<<" to path "<<par.obj_path<<std::endl;
+      if (paramtop.count("aggregate_output") != 0)
+      {
+	read(paramtop, "aggregate_output" ,par.aggregate_output);
+	QDPIO::cout<<"Aggregated correlator output set to "<<par.aggregate_output<<std::endl;
+      }
+      else
+	par.aggregate_output = false;
 #endif
 
       //We set output_full_correlator to true if no momentum is specified.
@@ -102,8 +110,36 @@ namespace Chroma
 	  par.is_mom_max = true;
 	  par.p2_max = 0;
       }
+      if (paramtop.count("ft_mode") != 0)
+      {
+	read(paramtop, "ft_mode" ,par.ft_mode);
+	lalibeSftModeFromString(par.ft_mode);
+	QDPIO::cout<<"Momentum projection mode set to "<<par.ft_mode<<std::endl;
+      }
+      else
+	par.ft_mode = "phases";
+      if (paramtop.count("t_range") != 0)
+      {
+	read(paramtop, "t_range" ,par.t_range);
+	if (par.t_range.size() != 2 || par.t_range[1] < par.t_range[0])
+	{
+	  QDPIO::cerr<<"t_range must be two time slices t_min t_max (relative to the source) with t_min <= t_max"<<std::endl;
+	  QDP_abort(1);
+	}
+	par.use_t_range = true;
+	QDPIO::cout<<"Only contracting time slices "<<par.t_range[0]<<" to "<<par.t_range[1]<<" relative to the source"<<std::endl;
+      }
+      else
+	par.use_t_range = false;
 
       read(paramtop, "particle_list", par.particle_list);
+      if (paramtop.count("all_gamma_channels") != 0)
+      {
+	read(paramtop, "all_gamma_channels" ,par.all_gamma_channels);
+	QDPIO::cout<<"Writing all 16x16 gamma channels for each particle set to "<<par.all_gamma_channels<<std::endl;
+      }
+      else
+	par.all_gamma_channels = false;
     }
 
     void write(XMLWriter& xml, const std::string& path, const MesonParams::Param_t& par)
@@ -114,13 +150,18 @@ namespace Chroma
 #ifdef BUILD_HDF5
       write(xml, "h5_file_name", par.file_name);
       write(xml, "obj_path", par.obj_path);
+      write(xml, "aggregate_output", par.aggregate_output);
 #endif
       //write(xml, "output_full_correlator", par.output_full_correlator);
       if(par.is_mom_max == true)
 	write(xml, "p2_max" ,par.p2_max);
       else
 	write(xml, "mom_list" ,par.mom_list);
+      write(xml, "ft_mode", par.ft_mode);
+      if(par.use_t_range == true)
+	write(xml, "t_range", par.t_range);
       write(xml, "particle_list", par.particle_list);
+      write(xml, "all_gamma_channels", par.all_gamma_channels);
 
       pop(xml);
     }
@@ -245,39 +286,43 @@ namespace Chroma
       QDPIO::cout<<"Meson contractions starting..."<<std::endl;
 
       //Grab all the propagators that are given.
-      XMLReader up_prop_file_xml, up_prop_record_xml;
-      LatticePropagator up_quark_propagator;
-      XMLReader down_prop_file_xml, down_prop_record_xml;
-      LatticePropagator down_quark_propagator;
-      XMLReader strange_prop_file_xml, strange_prop_record_xml;
-      LatticePropagator strange_quark_propagator;
-      XMLReader charm_prop_file_xml, charm_prop_record_xml;
-      LatticePropagator charm_quark_propagator;
+      std::vector<std::pair<char, std::string>> quark_ids;
+      if(params.named_obj.is_up == true)
+	quark_ids.push_back(std::make_pair('u', params.named_obj.up_quark));
+      if(params.named_obj.is_down == true)
+	quark_ids.push_back(std::make_pair('d', params.named_obj.down_quark));
+      if(params.named_obj.is_strange == true)
+	quark_ids.push_back(std::make_pair('s', params.named_obj.strange_quark));
+      if(params.named_obj.is_charm == true)
+	quark_ids.push_back(std::make_pair('c', params.named_obj.charm_quark));
+      std::map<char, LatticePropagator> prop_map;
       //Need origin, j_decay, and t0 for fourier transform!
       //Need j_decay of bc to know what comes with a minus sign.
       int j_decay;
       int t_0;
       multi1d<int> origin;
 
-      if(params.named_obj.is_up == true)
+      for (auto aQuark : quark_ids)
       {
-	QDPIO::cout << "Attempting to read up propagator" << std::endl;
+	char aFlav = aQuark.first;
+	QDPIO::cout << "Attempting to read "<<aFlav<<" propagator" << std::endl;
 	try
 	{
-	    up_quark_propagator = TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.up_quark);
-	    TheNamedObjMap::Instance().get(params.named_obj.up_quark).getFileXML(up_prop_file_xml);
-	    TheNamedObjMap::Instance().get(params.named_obj.up_quark).getRecordXML(up_prop_record_xml);
+	    prop_map[aFlav] = TheNamedObjMap::Instance().getData<LatticePropagator>(aQuark.second);
+	    XMLReader prop_file_xml, prop_record_xml;
+	    TheNamedObjMap::Instance().get(aQuark.second).getFileXML(prop_file_xml);
+	    TheNamedObjMap::Instance().get(aQuark.second).getRecordXML(prop_record_xml);
 	    //Get the origin  and j_decay for the FT, this assumes all quarks have the same origin.
 	    MakeSourceProp_t  orig_header;
-	    if (up_prop_record_xml.count("/Propagator") != 0)
+	    if (prop_record_xml.count("/Propagator") != 0)
 	    {
-	      QDPIO::cout<<"Up quark propagator is unsmeared, reading from Propagator tag..."<<std::endl;
-	      read(up_prop_record_xml, "/Propagator", orig_header);
+	      QDPIO::cout<<aFlav<<" quark propagator is unsmeared, reading from Propagator tag..."<<std::endl;
+	      read(prop_record_xml, "/Propagator", orig_header);
 	    }
-	    else if (up_prop_record_xml.count("/SinkSmear") != 0)
+	    else if (prop_record_xml.count("/SinkSmear") != 0)
 	    {
-	      QDPIO::cout<<"Up quark propagator is smeared, reading from SinkSmear tag..."<<std::endl;
-	      read(up_prop_record_xml, "/SinkSmear", orig_header);
+	      QDPIO::cout<<aFlav<<" quark propagator is smeared, reading from SinkSmear tag..."<<std::endl;
+	      read(prop_record_xml, "/SinkSmear", orig_header);
 	    }
 	    else
 	    {
@@ -289,149 +334,8 @@ namespace Chroma
 	    origin = orig_header.source_header.getTSrce();
 	    //If we need to rotate, we do it now.
 	    if(params.param.rotate_to_Dirac == true)
-	      rotate_to_Dirac_Basis(up_quark_propagator);
-            QDPIO::cout << name << ": Read up quark" << std::endl;
-
-	}
-	catch (std::bad_cast)
-	{
-	    QDPIO::cerr << name << ": caught dynamic cast error" << std::endl;
-	    QDP_abort(1);
-	}
-	catch (const std::string& e)
-	{
-	    QDPIO::cerr << name << ": error reading src prop_header: "
-		<< e << std::endl;
-	    QDP_abort(1);
-	}
-      }
-
-      if(params.named_obj.is_down == true)
-      {
-	QDPIO::cout << "Attempting to read down propagator" << std::endl;
-	try
-	{
-	    down_quark_propagator = TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.down_quark);
-	    TheNamedObjMap::Instance().get(params.named_obj.down_quark).getFileXML(down_prop_file_xml);
-	    TheNamedObjMap::Instance().get(params.named_obj.down_quark).getRecordXML(down_prop_record_xml);
-	    //Get the origin  and j_decay for the FT, this assumes all quarks have the same origin.
-
-	    MakeSourceProp_t  orig_header;
-	    if (down_prop_record_xml.count("/Propagator") != 0)
-	    {
-	      QDPIO::cout<<"Down quark propagator is unsmeared, reading from Propagator tag..."<<std::endl;
-	      read(down_prop_record_xml, "/Propagator", orig_header);
-	    }
-	    else if (down_prop_record_xml.count("/SinkSmear") != 0)
-	    {
-	      QDPIO::cout<<"Down quark propagator is smeared, reading from SinkSmear tag..."<<std::endl;
-	      read(down_prop_record_xml, "/SinkSmear", orig_header);
-	    }
-	    else
-	    {
-	      QDPIO::cout<<"What type of weird propagator did you give me? I can't find the right tag to get j_decay, source location, and whatnot...exiting..."<<std::endl;
-	    }
-
-	    j_decay = orig_header.source_header.j_decay;
-	    origin = orig_header.source_header.getTSrce();
-	    //If we need to rotate, we do it now.
-	    if(params.param.rotate_to_Dirac == true)
-	      rotate_to_Dirac_Basis(down_quark_propagator);
-            QDPIO::cout << name << ": Read down quark" << std::endl;
-
-	}
-	catch (std::bad_cast)
-	{
-	    QDPIO::cerr << name << ": caught dynamic cast error" << std::endl;
-	    QDP_abort(1);
-	}
-	catch (const std::string& e)
-	{
-	    QDPIO::cerr << name << ": error reading src prop_header: "
-		<< e << std::endl;
-	    QDP_abort(1);
-	}
-      }
-
-      if(params.named_obj.is_strange == true)
-      {
-	QDPIO::cout << "Attempting to read strange propagator" << std::endl;
-	try
-	{
-	    strange_quark_propagator = TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.strange_quark);
-	    TheNamedObjMap::Instance().get(params.named_obj.strange_quark).getFileXML(strange_prop_file_xml);
-	    TheNamedObjMap::Instance().get(params.named_obj.strange_quark).getRecordXML(strange_prop_record_xml);
-	    //Get the origin  and j_decay for the FT, this assumes all quarks have the same origin.
-
-	    MakeSourceProp_t  orig_header;
-	    if (strange_prop_record_xml.count("/Propagator") != 0)
-	    {
-	      QDPIO::cout<<"Strange quark propagator is unsmeared, reading from Propagator tag..."<<std::endl;
-	      read(strange_prop_record_xml, "/Propagator", orig_header);
-	    }
-	    else if (strange_prop_record_xml.count("/SinkSmear") != 0)
-	    {
-	      QDPIO::cout<<"Strange quark propagator is smeared, reading from SinkSmear tag..."<<std::endl;
-	      read(strange_prop_record_xml, "/SinkSmear", orig_header);
-	    }
-	    else
-	    {
-	      QDPIO::cout<<"What type of weird propagator did you give me? I can't find the right tag to get j_decay, source location, and whatnot...exiting..."<<std::endl;
-	    }
-
-	    j_decay = orig_header.source_header.j_decay;
-	    origin = orig_header.source_header.getTSrce();
-	    //If we need to rotate, we do it now.
-	    if(params.param.rotate_to_Dirac == true)
-	      rotate_to_Dirac_Basis(strange_quark_propagator);
-            QDPIO::cout << name << ": Read strange quark" << std::endl;
-
-	}
-	catch (std::bad_cast)
-	{
-	    QDPIO::cerr << name << ": caught dynamic cast error" << std::endl;
-	    QDP_abort(1);
-	}
-	catch (const std::string& e)
-	{
-	    QDPIO::cerr << name << ": error reading src prop_header: "
-		<< e << std::endl;
-	    QDP_abort(1);
-	}
-      }
-
-      if(params.named_obj.is_charm == true)
-      {
-	QDPIO::cout << "Attempting to read charm propagator" << std::endl;
-	try
-	{
-	    charm_quark_propagator = TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.charm_quark);
-	    TheNamedObjMap::Instance().get(params.named_obj.charm_quark).getFileXML(charm_prop_file_xml);
-	    TheNamedObjMap::Instance().get(params.named_obj.charm_quark).getRecordXML(charm_prop_record_xml);
-	    //Get the origin  and j_decay for the FT, this assumes all quarks have the same origin.
-	    MakeSourceProp_t  orig_header;
-
-	    if (charm_prop_record_xml.count("/Propagator") != 0)
-	    {
-	      QDPIO::cout<<"Charm quark propagator is unsmeared, reading from Propagator tag..."<<std::endl;
-	      read(charm_prop_record_xml, "/Propagator", orig_header);
-	    }
-	    else if (charm_prop_record_xml.count("/SinkSmear") != 0)
-	    {
-	      QDPIO::cout<<"Charm quark propagator is smeared, reading from SinkSmear tag..."<<std::endl;
-	      read(charm_prop_record_xml, "/SinkSmear", orig_header);
-	    }
-	    else
-	    {
-	      QDPIO::cout<<"What type of weird propagator did you give me? I can't find the right tag to get j_decay, source location, and whatnot...exiting..."<<std::endl;
-	    }
-
-	    j_decay = orig_header.source_header.j_decay;
-	    origin = orig_header.source_header.getTSrce();
-	    //If we need to rotate, we do it now.
-	    if(params.param.rotate_to_Dirac == true)
-	      rotate_to_Dirac_Basis(charm_quark_propagator);
-            QDPIO::cout << name << ": Read charm quark" << std::endl;
+	      rotate_to_Dirac_Basis(prop_map[aFlav]);
+            QDPIO::cout << name << ": Read "<<aFlav<<" quark" << std::endl;
 
 	}
 	catch (std::bad_cast)
@@ -448,135 +352,106 @@ namespace Chroma
       }
 
       //Initialize FT stuff here, whether this is used or not below is another story...
-      LalibeSftMom ft = params.param.is_mom_max ? LalibeSftMom(params.param.p2_max, origin, false, j_decay)
-	: LalibeSftMom(params.param.p_list, origin, j_decay);
+      LalibeSftMode ft_mode = lalibeSftModeFromString(params.param.ft_mode);
+      LalibeSftMom ft = params.param.is_mom_max ? LalibeSftMom(params.param.p2_max, origin, false, j_decay, ft_mode)
+	: LalibeSftMom(params.param.p_list, origin, j_decay, ft_mode);
+      //Restrict everything below to the requested time slices.
+      if(params.param.use_t_range)
+	ft.setTimeWindow(t_0 + params.param.t_range[0], params.param.t_range[1] - params.param.t_range[0] + 1);
 
       //Here's Nt, we need this.
       int Nt = Layout::lattSize()[j_decay];
 
 #ifdef BUILD_HDF5
       //If we are writing with hdf5, the start up is done here.
-      HDF5Writer h5out(params.param.file_name);
+      HDF5Writer& h5out = lalibeHDF5Writer(params.param.file_name);
       //h5out.push(params.param.obj_path);
       HDF5Base::writemode wmode;
       wmode = HDF5Base::ate;
 #endif
 
       //Next we do the contractions for the specified particles.
-      //This is going to be a horrible set of if statements for now, may change this later.
-      //Loop over list of particles.
-
+      //Skip the particles we do not have the quarks for, then evaluate the rest from the meson table in one batch,
+      //so particles that share a quark-antiquark pair share one pass over the propagators.
+      std::vector<std::string> particle_list;
       for(int particle_index = 0; particle_index < params.param.particle_list.size(); particle_index++)
       {
+	const std::string & aParticle = params.param.particle_list[particle_index];
+	QDPIO::cout<<"Particle number "<<(particle_index+1)<<" is the "<<aParticle<<"."<<std::endl;
+	bool have_quarks = true;
+	for(auto aFlav : get_meson_flavors(aParticle))
+	  if(prop_map.find(aFlav) == prop_map.end())
+	    have_quarks = false;
+	if(have_quarks)
+	  particle_list.push_back(aParticle);
+	else
+	  QDPIO::cout<<"Sorry, I couldn't find all the quarks for the "<<aParticle<<". Skipping the "<<aParticle<<" contraction..."<<std::endl;
+      }
 
-	if(params.param.particle_list[particle_index] == "piplus")
-	{
-	  QDPIO::cout<<"Particle number "<<(particle_index+1)<<" is the piplus."<<std::endl;
-	  QDPIO::cout<<"Checking to make sure we have the correct quark propagators to compute the piplus."<<std::endl;
-	  if(params.named_obj.is_up == true && params.named_obj.is_down == true)
-	  {
-	    QDPIO::cout<<"Found up and down quarks for the piplus. Starting calculation..."<<std::endl;
-
-
-	    LatticeComplex piplus = zero;
-
-	    I_one_Iz_pm_one_contract(up_quark_propagator, down_quark_propagator, piplus);
+      std::vector<std::string> meson_names;
+      std::map<std::string, LatticeComplex> mesons;
+      do_meson_contractions(prop_map, particle_list, params.param.rotate_to_Dirac, meson_names, mesons, ft.getWindow());
 
-        // Write out the correlator.
-	    write_correlator(params.param.output_full_correlator,
-		"piplus",
 #ifdef BUILD_HDF5
-		params.param.obj_path, h5out, wmode,
+      LalibeCorrelatorBuffer buffer(ft, Nt);
+      LalibeCorrelatorBuffer * aggregate = params.param.aggregate_output ? &buffer : NULL;
 #endif
-		t_0, Nt, origin, ft, piplus);
-      }
-	  else
-	    QDPIO::cout<<"Sorry, I couldn't find both an up quark and down quark. Skipping the piplus contraction..."<<std::endl;
-	}
-
- 	if(params.param.particle_list[particle_index] == "piminus")
+      // Write out a batch of correlators, projecting them all in one sweep unless the full correlator is wanted.
+      auto write_mesons = [&](const std::vector<std::string> & names, const std::vector<LatticeComplex*> & fields)
+      {
+	if(params.param.output_full_correlator)
 	{
-	  QDPIO::cout<<"Particle number "<<(particle_index+1)<<" is the piminus."<<std::endl;
-	  QDPIO::cout<<"Checking to make sure we have the correct quark propagators to compute the piminus."<<std::endl;
-	  if(params.named_obj.is_up == true && params.named_obj.is_down == true)
-	  {
-	    QDPIO::cout<<"Found up and down quarks for the piminus. Starting calculation..."<<std::endl;
-
-
-	    LatticeComplex piminus = zero;
-
-	    I_one_Iz_pm_one_contract(down_quark_propagator, up_quark_propagator, piminus);
-
-        // Write out the correlator.
-	    write_correlator(params.param.output_full_correlator,
-		"piminus",
+	  for(unsigned int i = 0; i < names.size(); i++)
+	    write_correlator(true, names[i],
 #ifdef BUILD_HDF5
 		params.param.obj_path, h5out, wmode,
 #endif
-		t_0, Nt, origin, ft, piminus);
-
-
-      }
-	  else
-	    QDPIO::cout<<"Sorry, I couldn't find both an up quark and down quark. Skipping the piminus contraction..."<<std::endl;
+		t_0, Nt, origin, ft, *fields[i]);
+	  return;
 	}
 
-	if(params.param.particle_list[particle_index] == "kplus")
-	{
-	  QDPIO::cout<<"Particle number "<<(particle_index+1)<<" is the kplus."<<std::endl;
-	  QDPIO::cout<<"Checking to make sure we have the correct quark propagators to compute the kplus."<<std::endl;
-	  if(params.named_obj.is_up == true && params.named_obj.is_strange == true)
-	  {
-	    QDPIO::cout<<"Found up and strange quarks for the kplus. Starting calculation..."<<std::endl;
-
-
-	    LatticeComplex kplus = zero;
-
-	    I_one_Iz_pm_one_contract(up_quark_propagator, strange_quark_propagator, kplus);
-
-        // Write out the correlator.
-	    write_correlator(params.param.output_full_correlator,
-		"kplus",
+	std::vector<const LatticeComplex*> field_list(fields.begin(), fields.end());
+	multi1d<multi2d<DComplex>> FTed_mesons = ft.sft(field_list);
+	for(unsigned int i = 0; i < names.size(); i++)
+	  write_correlator(names[i],
 #ifdef BUILD_HDF5
-		params.param.obj_path, h5out, wmode,
+	      params.param.obj_path, h5out, wmode, aggregate,
 #endif
-		t_0, Nt, origin, ft, kplus);
-
-      }
-	  else
-	    QDPIO::cout<<"Sorry, I couldn't find both an up quark and down quark. Skipping the kplus contraction..."<<std::endl;
-	}
-
-	if(params.param.particle_list[particle_index] == "kminus")
-	{
-	  QDPIO::cout<<"Particle number "<<(particle_index+1)<<" is the kminus."<<std::endl;
-	  QDPIO::cout<<"Checking to make sure we have the correct quark propagators to compute the kminus."<<std::endl;
-	  if(params.named_obj.is_up == true && params.named_obj.is_strange == true)
+	      t_0, Nt, origin, ft, FTed_mesons[i]);
+      };
+
+      std::vector<LatticeComplex*> meson_list;
+      for(auto aMeson : meson_names)
+	meson_list.push_back(&mesons[aMeson]);
+      write_mesons(meson_names, meson_list);
+      mesons.clear();
+
+      // Every gamma channel of the single-pair mesons, one sink gamma at a time, so only Ns*Ns channels
+      // are held at once and each batch is written and freed before the next is contracted.
+      if(params.param.all_gamma_channels)
+      {
+	for(auto aMeson : meson_names)
+	  for(int snk = 0; snk < Ns*Ns; snk++)
 	  {
-	    QDPIO::cout<<"Found up and strange quarks for the kminus. Starting calculation..."<<std::endl;
-
-
-	    LatticeComplex kminus = zero;
+	    std::vector<std::string> channel_names;
+	    multi1d<LatticeComplex> channels;
+	    if(!meson_gamma_channels(prop_map, aMeson, snk, params.param.rotate_to_Dirac, channel_names, channels, ft.getWindow()))
+	      break;
+
+	    std::vector<LatticeComplex*> channel_list;
+	    for(int ch = 0; ch < channels.size(); ch++)
+	      channel_list.push_back(&channels[ch]);
+	    write_mesons(channel_names, channel_list);
+	  }
+      }
 
-	    I_one_Iz_pm_one_contract(strange_quark_propagator,up_quark_propagator, kminus);
-        // Write out the correlator.
-	    write_correlator(params.param.output_full_correlator,
-		"kminus",
 #ifdef BUILD_HDF5
-		params.param.obj_path, h5out, wmode,
+      if(!params.param.output_full_correlator)
+	buffer.write(params.param.obj_path, origin, h5out, wmode);
 #endif
-		t_0, Nt, origin, ft, kminus);
-
-      }
-	  else
-	    QDPIO::cout<<"Sorry, I couldn't find both an up quark and down quark. Skipping the kminus contraction..."<<std::endl;
-	}
-
-      }
 
 #ifdef BUILD_HDF5
       h5out.cd("/");
-      h5out.close();
 #endif
 
       //pop(xml_out);
@@ -40,10 +40,15 @@ namespace Chroma
 	int p2_max;                           //max of momentum transfer squared, optional
 	multi1d<multi1d<int>> mom_list;       //list of momenta insertions, optional
 	multi2d<int> p_list;                  //momentum list the slow fourier transform needs
+	std::string ft_mode;                  //"phases" (default), "compact" or "fft" momentum projection
+	bool use_t_range;                     //restrict contractions and FTs to a window of time slices, optional
+	multi1d<int> t_range;                 //[t_min, t_max] of that window relative to the source time
 	multi1d<std::string> particle_list;   //list of actual particles we gunna make from the contractions yo
+	bool all_gamma_channels;              //also write every (Gamma_snk, Gamma_src) pair for each particle, optional
 #ifdef BUILD_HDF5
 	std::string file_name;
 	std::string obj_path;
+	bool aggregate_output;                //write all projected correlators as one dataset per source, optional
 #endif
       } param;
 
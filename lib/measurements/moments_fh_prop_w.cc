@@ -24,6 +24,7 @@ OUTPUT
 
 // Lalibe Stuff
 #include "moments_fh_prop_w.h"
+#include "../numerics/fermion_state_cache_w.h"
 #include "../matrix_elements/chromomag_seqsource_w.h"
 
 namespace Chroma
@@ -240,10 +241,9 @@ namespace Chroma
 	    typedef multi1d<LatticeColorMatrix> P;
 	    typedef multi1d<LatticeColorMatrix> Q;
 
-	    std::istringstream xml_action(params.momentsfhparam.prop_param.fermact.xml);
-	    XMLReader action_reader(xml_action);
-	    Handle<FermionAction<T, P, Q>> action(TheFermionActionFactory::Instance().createObject(params.momentsfhparam.prop_param.fermact.id, action_reader, params.momentsfhparam.prop_param.fermact.path));
-	    Handle<FermState<T, P, Q>> action_state(action->createState(u));
+	    LalibeFermStateCache& ferm_cache = lalibeFermStateCache(params.momentsfhparam.prop_param.fermact, params.named_obj.gauge_id, u);
+	    Handle<FermionAction<T, P, Q>> action = ferm_cache.action;
+	    Handle<FermState<T, P, Q>> action_state = ferm_cache.state;
 	    QDPIO::cout<<"Our action and fermion state are doing A-okay so far."<<std::endl;
 
 	    int ncg_had = 0; //This appears in the propagator task, I am just copying it here.
@@ -23,10 +23,13 @@ OUTPUT
 #include "util/info/unique_id.h"
 //We need this to insert Fermions to a Prop, this is imperitive for dilution.
 #include "util/ferm/transf.h"
+#include <algorithm>
 
 // Lalibe Stuff
 #include "stochastic_fh_prop_w.h"
 #include "../matrix_elements/bilinear_gamma.h"
+#include "../matrix_elements/stochastic_outer_product_w.h"
+#include "../numerics/noise_source_w.h"
 
 namespace Chroma
 {
@@ -65,6 +68,10 @@ namespace Chroma
 	    read(paramtop, "ending_vector" ,par.ending_vector );
 	    read(paramtop, "Seed" ,par.ran_seed );
 	    read(paramtop, "ZN" ,par.ZN );
+	    if (paramtop.count("noise_engine") != 0)
+	      read(paramtop, "noise_engine" ,par.noise_engine );
+	    else
+	      par.noise_engine = "qdp";
 	    if (paramtop.count("p2_max") != 0)
 	    {
   	      read(paramtop, "p2_max" ,par.p2_max);
@@ -105,6 +112,20 @@ namespace Chroma
 		par.delete_props = false;
 		QDPIO::cout<<"By default, no props will be deleted after sum "<<std::endl;
 	    }
+	    if (paramtop.count("source_cache_size") != 0)
+	    {
+		read(paramtop, "source_cache_size", par.source_cache_size);
+		QDPIO::cout<<"At most "<<par.source_cache_size<<" current-inserted sources will be cached at a time "<<std::endl;
+	    }
+	    else
+		par.source_cache_size = 0;
+	    if (paramtop.count("memory_budget_mb") != 0)
+	    {
+		read(paramtop, "memory_budget_mb", par.memory_budget_mb);
+		QDPIO::cout<<"The propagators held by this task will use at most "<<par.memory_budget_mb<<" MB per node "<<std::endl;
+	    }
+	    else
+		par.memory_budget_mb = 0;
         }
 
         void write(XMLWriter& xml, const std::string& path, StochasticFHParams::StochasticFHProp_t& par)
@@ -116,11 +137,14 @@ namespace Chroma
 	    write(xml, "ending_vector" ,par.ending_vector);
 	    write(xml, "Seed" ,par.ran_seed);
 	    write(xml, "ZN" ,par.ZN);
+	    write(xml, "noise_engine" ,par.noise_engine);
 	    if(par.is_mom_max == true)
 	      write(xml, "p2_max" ,par.p2_max);
 	    else
 	      write(xml, "mom_list" ,par.mom_list);
 	    write(xml, "delete_props" ,par.delete_props);
+	    write(xml, "source_cache_size" ,par.source_cache_size);
+	    write(xml, "memory_budget_mb" ,par.memory_budget_mb);
             pop(xml);
 
         }
@@ -277,35 +301,13 @@ namespace Chroma
               : LalibeSftMom(params.stochfhparam.p_list, origin, j_decay);
 	    // Make an action and all other stuff needed for a solver.
 
-	    LatticePropagator fh_prop_src = quark_propagator;
 	    LatticePropagator noise_src = zero;
 	    LatticePropagator stochastic_fh_prop = zero;
 
 	    //Here's where the actual noisy stuff happens.
-	    multi1d <LatticeComplex> vectors;
-	    vectors.resize(params.stochfhparam.ending_vector - params.stochfhparam.starting_vector + 1);
-	    LatticeComplex vec ;
-	    Seed ran_seed;
-	    QDP::RNG::savern(ran_seed);
-
-	    // Set the seed to desired value
-	    QDP::RNG::setrn(params.stochfhparam.ran_seed);
-
-	    for(int current_vec = 0; current_vec < params.stochfhparam.ending_vector; current_vec++)
-	    {
-	      int N  = params.stochfhparam.ZN;
-	      LatticeReal rnd1, theta;
-	      // twopi defined in chroma/lib/chromabase.h
-	      Real twopiN = Chroma::twopi / N;
-	      random(rnd1);
-	      theta = twopiN * floor(N*rnd1);
-	      vec = cmplx(cos(theta),sin(theta));
-	      if ((current_vec + 1) >= params.stochfhparam.starting_vector)
-		vectors[current_vec - params.stochfhparam.starting_vector + 1] = vec;
-	    }
-
-	    //restore the seed
-	    QDP::RNG::setrn(ran_seed);
+	    //Each vector is made when it is needed, straight from the seed and its vector number.
+	    Handle<LalibeNoiseSource> noise = lalibeZNNoiseSource(params.stochfhparam.noise_engine, params.stochfhparam.ran_seed, params.stochfhparam.ZN);
+	    const int num_vecs = params.stochfhparam.ending_vector - params.stochfhparam.starting_vector + 1;
 
 	    //This is the old way of doing the noise bit.
 	    //Now let's do some dilution and turn this noise into a proper quark!
@@ -327,150 +329,158 @@ namespace Chroma
 	      }
 	    }*/
 
-	    //In order to the sum over noise vectors inside here instead of post-processing, we need accumulators.
-	    multi1d <LatticePropagator> accumulated_props;
-	    accumulated_props.resize(params.named_obj.fh_prop_id.size());
-	    //Zero out the accumulators, just to be safe from dirty memory.
-	    for(int accumulation_index = 0; accumulation_index < accumulated_props.size(); accumulation_index++)
-	      accumulated_props[accumulation_index] = zero;
-
-	    //Noise loop
-	    for(int vec_index = 0; vec_index < vectors.size(); vec_index++)
+	    //The current-inserted, momentum-phased sources do not depend on the noise, so they are built once
+	    //and reused for every noise vector. At most source_cache_size of them, and no more than fit in
+	    //memory_budget_mb, are held at a time; if there are more (current, mom) pairs than that, they are
+	    //done in blocks and the noise props are revisited per block.
+	    const int num_sources = params.stochfhparam.currents.size()*ft.numMom();
+	    int cache_size = fh_source_block_size(num_sources, params.stochfhparam.source_cache_size);
+	    if (params.stochfhparam.memory_budget_mb > 0)
 	    {
-              // Read "noise" quark propagator, now this is done inside a loop over noise vectors
-	      XMLReader noise_prop_file_xml, noise_prop_record_xml;
-	      LatticePropagator noise_quark_propagator;
-	      QDPIO::cout << "Attempt to read noise propagator number " << vec_index << std::endl;
-	      try
-	      {
-		  noise_quark_propagator = TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.noise_prop_id[vec_index]);
-		  TheNamedObjMap::Instance().get(params.named_obj.noise_prop_id[vec_index]).getFileXML(noise_prop_file_xml);
-		  TheNamedObjMap::Instance().get(params.named_obj.noise_prop_id[vec_index]).getRecordXML(noise_prop_record_xml);
-	      }
-              catch (std::bad_cast)
+	      //The budget covers every propagator the task holds at its peak: the noise props it reads, all of
+	      //its outputs, the copy of the source prop, the two work props and the unphased current-inserted
+	      //source, whatever is left over goes to the cache.
+	      const double prop_mb = double(Layout::sitesOnNode())*Ns*Ns*Nc*Nc*2*sizeof(REAL)/(1024.0*1024.0);
+	      const int resident_props = num_vecs + num_sources + 4;
+	      const int budget_size = int(params.stochfhparam.memory_budget_mb/prop_mb) - resident_props;
+	      if (budget_size < 1)
 	      {
-		  QDPIO::cerr << name << ": caught dynamic cast error" << std::endl;
-		  QDP_abort(1);
+		QDPIO::cerr << name << ": memory_budget_mb = " << params.stochfhparam.memory_budget_mb
+		    << " does not fit the " << resident_props << " resident propagators and one cached source, "
+		    << (resident_props + 1)*prop_mb << " MB per node are needed" << std::endl;
+		QDP_abort(1);
 	      }
-	      catch (const std::string& e)
+	      cache_size = std::min(cache_size, budget_size);
+	    }
+	    multi1d <LatticePropagator> phased_srcs;
+	    phased_srcs.resize(cache_size);
+	    QDPIO::cout << "STOCHASTIC_FH_PROPAGATOR: caching " << cache_size << " of " << num_sources
+		<< " current-inserted sources at a time" << std::endl;
+
+	    for(int block_start = 0; block_start < num_sources; block_start += cache_size)
+	    {
+	      const int block_end = std::min(block_start + cache_size, num_sources);
+	      phased_fh_sources(params.stochfhparam.currents, quark_propagator, u, ft, block_start, block_end, phased_srcs);
+	      const bool last_block = (block_end == num_sources);
+
+	      //The sum over noise vectors goes straight into this block's output props, there are no separate
+	      //accumulators, so a finished block holds nothing but its results.
+	      for(int source_index = block_start; source_index < block_end; source_index++)
 	      {
-		  QDPIO::cerr << name << ": error reading noise prop_header: "
-		      << e << std::endl;
-		  QDP_abort(1);
+		std::string current_id = params.named_obj.fh_prop_id[source_index];
+		TheNamedObjMap::Instance().create<LatticePropagator>(current_id);
+		TheNamedObjMap::Instance().getData<LatticePropagator>(current_id) = zero;
 	      }
-	      for(int current_index = 0; current_index < params.stochfhparam.currents.size(); current_index++)
+
+	      //Noise loop
+	      for(int vec_index = 0; vec_index < num_vecs; vec_index++)
 	      {
-		std::string present_current = params.stochfhparam.currents[current_index];
-		QDPIO::cout << "STOCHASTIC_FH_PROPAGATOR: current " << present_current << std::endl;
-		// WE SHOULD MAKE THIS A FACTORY
-		Bilinear_Gamma(present_current, fh_prop_src, quark_propagator, u);
-		for(int mom = 0; mom < ft.numMom(); mom++)
+		// Read "noise" quark propagator, now this is done inside a loop over noise vectors
+		XMLReader noise_prop_file_xml, noise_prop_record_xml;
+		QDPIO::cout << "Attempt to read noise propagator number " << vec_index << std::endl;
+		const LatticePropagator* noise_ptr = 0;
+		try
+		{
+		    //Work straight off the stored object, no copy is needed.
+		    noise_ptr = &TheNamedObjMap::Instance().getData<LatticePropagator>(params.named_obj.noise_prop_id[vec_index]);
+		    TheNamedObjMap::Instance().get(params.named_obj.noise_prop_id[vec_index]).getFileXML(noise_prop_file_xml);
+		    TheNamedObjMap::Instance().get(params.named_obj.noise_prop_id[vec_index]).getRecordXML(noise_prop_record_xml);
+		}
+		catch (std::bad_cast)
+		{
+		    QDPIO::cerr << name << ": caught dynamic cast error" << std::endl;
+		    QDP_abort(1);
+		}
+		catch (const std::string& e)
+		{
+		    QDPIO::cerr << name << ": error reading noise prop_header: "
+			<< e << std::endl;
+		    QDP_abort(1);
+		}
+		LatticeComplex vec;
+		(*noise)(params.stochfhparam.starting_vector + vec_index, vec);
+		const LatticePropagator& noise_quark_propagator = *noise_ptr;
+		for(int source_index = block_start; source_index < block_end; source_index++)
 		{
-
-		  multi1d<int> momenta = ft.numToMom(mom);
-		  QDPIO::cout << "Injecting momentum - px: "<<std::to_string(momenta[0])<<" py: "+std::to_string(momenta[1])<<" pz: "+std::to_string(momenta[2])<<std::endl;
-		  fh_prop_src = ft[mom]*fh_prop_src;
 		  //Below is the thing that matters.
 		  //The noise_prop is tied with the source_prop and noise_src to make the stochastic FH prop.
 		  //stochastic_fh_prop = noise_quark_propagator*innerProduct(noise_src, fh_prop_src);
-		  //Instead of doing the above, I will manually specify indices.
-		  for(int fh_color_source(0);fh_color_source<Nc;fh_color_source++){
-		    //Nested spin/color loop so our dilution vectors hit every propagator component.
-		    //QDPIO::cout<<"Extracing Feynman Hellman color "<<fh_color_source<<std::endl;
-		    for(int fh_spin_source=0; fh_spin_source < Ns; fh_spin_source++){
-		      LatticeFermion fh_ferm = zero;
-		      //QDPIO::cout<<"Tying Feynman Hellman spin "<<fh_spin_source<<" to diluted noise."<<std::endl;
-		      PropToFerm(fh_prop_src, fh_ferm, fh_color_source, fh_spin_source);
-		      LatticeFermion stochastic_fh_ferm = zero;
-		      for(int color_source(0);color_source<Nc;color_source++){
-			LatticeColorVector vec_srce = zero ;
-			pokeColor(vec_srce,vectors[vec_index],color_source) ;
-			for(int spin_source=0; spin_source < Ns; spin_source++){
-			  LatticeFermion chi = zero;
-			  CvToFerm(vec_srce, chi, spin_source);
-			  LatticeFermion noise_ferm = zero;
-			  PropToFerm(noise_quark_propagator, noise_ferm, color_source, spin_source);
-			  stochastic_fh_ferm += noise_ferm*innerProduct(chi, fh_ferm);
-			}
-		      }
-		      FermToProp(stochastic_fh_ferm, stochastic_fh_prop, fh_color_source, fh_spin_source);
-		    }
-		  }
+		  //Diluting the noise over spin and color makes the 144 inner products one 12x12 overlap matrix,
+		  //which is reduced in a single sweep and then multiplied into the noise prop site by site.
+		  noise_outer_product(noise_quark_propagator, vec, phased_srcs[source_index - block_start], stochastic_fh_prop);
 		  //Below we accumulate.
-		  std::string current_id = params.named_obj.fh_prop_id[current_index*ft.numMom() + mom];
+		  std::string current_id = params.named_obj.fh_prop_id[source_index];
 		  QDPIO::cout<<"Adding outer product to prop with id "<<current_id<<std::endl;
-		  accumulated_props[current_index*ft.numMom() + mom] += stochastic_fh_prop;
+		  TheNamedObjMap::Instance().getData<LatticePropagator>(current_id) += stochastic_fh_prop;
+		}
+		//Only delete once every block has used the noise prop.
+		if (params.stochfhparam.delete_props && last_block)
+		{
+		  // Deleting the object.
+		  TheNamedObjMap::Instance().erase(params.named_obj.noise_prop_id[vec_index]);
 		}
 	      }
-	      if (params.stochfhparam.delete_props)
-	      {
-		// Deleting the object.
-		TheNamedObjMap::Instance().erase(params.named_obj.noise_prop_id[vec_index]);
-	      }
-	    }
 
-	    //Divide by the total number of noise_vecs to create an average, then ship out result.
-	    for(int accumulation_index = 0; accumulation_index < accumulated_props.size(); accumulation_index++)
-	    {
-	      accumulated_props[accumulation_index] /= vectors.size();
-	      push(xml_out,"Relaxation_Iterations");
-	      //ncg_had not needed since no inversion is happening
-	      //write(xml_out, "ncg_had", ncg_had);
-	      pop(xml_out);
-
-	      QDPIO::cout << "Writing propagator info, cause why not?" << std::endl;
-	      XMLBufferWriter file_xml;
-	      push(file_xml, "propagator");
-	      write(file_xml, "id", uniqueId());  // NOTE: new ID form
-	      pop(file_xml);
-
-	      //If ths src is not from make source these thing is not going to work...
-	      XMLBufferWriter record_xml;
-	      if (propagatorP)
-	      {
-		//MakeSourceProp_t  orig_header;
-		Propagator_t  orig_header;
-		read(prop_record_xml, "/Propagator", orig_header);
-		//Note below:
-		//Normally we copy relevant header info and use new prop_params, but this task doesn't do any inversions...
-		//This requies changing types from Propagator to MakeSourceProp.
-		//Propagator_t  new_header;   // note, abandoning state_info
-		//Therefore, here the src_header is just completely copied over.
-		//new_header.prop_header   = orig_header.params.hpfhparam.prop_param;
-		//new_header.source_header = orig_header.source_header;
-		//new_header.gauge_header  = orig_header.gauge_header;
-		//MakeSourceProp_t  new_header = orig_header;
-		Propagator_t  new_header = orig_header;
-		write(record_xml, "Propagator", new_header);
-	      }
-	      else if (seqsourceP)
+	      //Divide by the total number of noise_vecs to create an average, then ship out the block's results.
+	      for(int source_index = block_start; source_index < block_end; source_index++)
 	      {
-		SequentialSource_t  orig_header;
-		read(prop_record_xml, "/SequentialSource", orig_header);
-
-		SequentialProp_t  new_header;   // note, abandoning state_info
-		//Dig into first quark and copy its chroma_prop xml stuff.
-		new_header.seqprop_header   = orig_header.forward_props[0].prop_header;
-		new_header.sink_header      = orig_header.sink_header;
-		new_header.seqsource_header = orig_header.seqsource_header;
-		new_header.forward_props    = orig_header.forward_props;
-		new_header.gauge_header     = orig_header.gauge_header;
-		write(record_xml, "SequentialProp", new_header);
-	      }
+		std::string current_id = params.named_obj.fh_prop_id[source_index];
+		TheNamedObjMap::Instance().getData<LatticePropagator>(current_id) /= num_vecs;
+		push(xml_out,"Relaxation_Iterations");
+		//ncg_had not needed since no inversion is happening
+		//write(xml_out, "ncg_had", ncg_had);
+		pop(xml_out);
+
+		QDPIO::cout << "Writing propagator info, cause why not?" << std::endl;
+		XMLBufferWriter file_xml;
+		push(file_xml, "propagator");
+		write(file_xml, "id", uniqueId());  // NOTE: new ID form
+		pop(file_xml);
+
+		//If ths src is not from make source these thing is not going to work...
+		XMLBufferWriter record_xml;
+		if (propagatorP)
+		{
+		  //MakeSourceProp_t  orig_header;
+		  Propagator_t  orig_header;
+		  read(prop_record_xml, "/Propagator", orig_header);
+		  //Note below:
+		  //Normally we copy relevant header info and use new prop_params, but this task doesn't do any inversions...
+		  //This requies changing types from Propagator to MakeSourceProp.
+		  //Propagator_t  new_header;   // note, abandoning state_info
+		  //Therefore, here the src_header is just completely copied over.
+		  //new_header.prop_header   = orig_header.params.hpfhparam.prop_param;
+		  //new_header.source_header = orig_header.source_header;
+		  //new_header.gauge_header  = orig_header.gauge_header;
+		  //MakeSourceProp_t  new_header = orig_header;
+		  Propagator_t  new_header = orig_header;
+		  write(record_xml, "Propagator", new_header);
+		}
+		else if (seqsourceP)
+		{
+		  SequentialSource_t  orig_header;
+		  read(prop_record_xml, "/SequentialSource", orig_header);
 
-	      // Pass the propagator info to the Named Object Buffer.
-	      // Looping over currents and momenta, momenta is inner most index
-	      // current_id = flattened index running over both these indices
-	      //std::string current_id = params.named_obj.fh_prop_id[current_index*vectors.size()*ft.numMom() + vec_index*ft.numMom() + mom];
-	      //Above is old index ordering, doesn't make much sense now.
-	      std::string current_id = params.named_obj.fh_prop_id[accumulation_index];
-	      TheNamedObjMap::Instance().create<LatticePropagator>(current_id);
-	      TheNamedObjMap::Instance().getData<LatticePropagator>(current_id) = accumulated_props[accumulation_index];
-	      TheNamedObjMap::Instance().get(current_id).setFileXML(file_xml);
-	      TheNamedObjMap::Instance().get(current_id).setRecordXML(record_xml);
-	      QDPIO::cout<<"YAAAY! We finished current: "<<current_id<<std::endl;
-	    }
+		  SequentialProp_t  new_header;   // note, abandoning state_info
+		  //Dig into first quark and copy its chroma_prop xml stuff.
+		  new_header.seqprop_header   = orig_header.forward_props[0].prop_header;
+		  new_header.sink_header      = orig_header.sink_header;
+		  new_header.seqsource_header = orig_header.seqsource_header;
+		  new_header.forward_props    = orig_header.forward_props;
+		  new_header.gauge_header     = orig_header.gauge_header;
+		  write(record_xml, "SequentialProp", new_header);
+		}
 
+		// Pass the propagator info to the Named Object Buffer.
+		// Looping over currents and momenta, momenta is inner most index
+		// current_id = flattened index running over both these indices
+		//std::string current_id = params.named_obj.fh_prop_id[current_index*vectors.size()*ft.numMom() + vec_index*ft.numMom() + mom];
+		//Above is old index ordering, doesn't make much sense now.
+		TheNamedObjMap::Instance().get(current_id).setFileXML(file_xml);
+		TheNamedObjMap::Instance().get(current_id).setRecordXML(record_xml);
+		QDPIO::cout<<"YAAAY! We finished current: "<<current_id<<std::endl;
+	      }
+	    }
 
 	    snoop.stop();
 	    QDPIO::cout << LalibeStochasticFHPropagatorEnv::name << ": total time = " << snoop.getTimeInSeconds() << " secs" << std::endl;
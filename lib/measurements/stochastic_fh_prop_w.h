@@ -47,7 +47,10 @@ namespace Chroma
 	int ending_vector;		      //ending vector number, to simplify things, this should be 1 for a new gauge cfg
 	Seed ran_seed; 			      //seed value, keeping this the same for stoch_fh and disco is crucial!
 	int ZN;                               //the type of random noise
+	std::string noise_engine;              //"qdp" (default) or "counter", must match between the ZN inversion and its contractions
 	bool delete_props;                    // Delete props after being summed, by default this is turned off.
+	int source_cache_size;                // Max number of current-inserted sources held at once, <= 0 means all of them.
+	double memory_budget_mb;              // Per-node MB for all propagators the task holds, sources are cached in what is left, <= 0 means no limit.
       } stochfhparam ;
 
       struct NamedObject_t
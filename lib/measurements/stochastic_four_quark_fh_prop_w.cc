@@ -25,6 +25,8 @@ OUTPUT
 
 // Lalibe Stuff
 #include "stochastic_four_quark_fh_prop_w.h"
+#include "../numerics/fermion_state_cache_w.h"
+#include "../numerics/noise_source_w.h"
 #include "../matrix_elements/chromomag_seqsource_w.h"
 #include "../matrix_elements/bilinear_gamma.h"
 
@@ -72,6 +74,10 @@ namespace Chroma
 	    read(paramtop, "vector_number" ,par.vector_number );
 	    read(paramtop, "Seed" ,par.ran_seed );
 	    read(paramtop, "ZN" ,par.ZN );
+	    if (paramtop.count("noise_engine") != 0)
+	      read(paramtop, "noise_engine" ,par.noise_engine );
+	    else
+	      par.noise_engine = "qdp";
 	    read(paramtop, "conjugate" ,par.conjugate );
 	    if (paramtop.count("p2_max") != 0)
 	    {
@@ -115,6 +121,7 @@ namespace Chroma
 	    write(xml, "vector_number" ,par.vector_number);
 	    write(xml, "Seed" ,par.ran_seed);
 	    write(xml, "ZN" ,par.ZN);
+	    write(xml, "noise_engine" ,par.noise_engine);
 	    write(xml, "conjugate" ,par.conjugate);
 	    if(par.is_mom_max == true)
 	      write(xml, "p2_max" ,par.p2_max);
@@ -257,10 +264,9 @@ namespace Chroma
 	    typedef multi1d<LatticeColorMatrix> P;
 	    typedef multi1d<LatticeColorMatrix> Q;
 
-	    std::istringstream xml_action(params.stochfourqfhparam.prop_param.fermact.xml);
-	    XMLReader action_reader(xml_action);
-	    Handle<FermionAction<T, P, Q>> action(TheFermionActionFactory::Instance().createObject(params.stochfourqfhparam.prop_param.fermact.id, action_reader, params.stochfourqfhparam.prop_param.fermact.path));
-	    Handle<FermState<T, P, Q>> action_state(action->createState(u));
+	    LalibeFermStateCache& ferm_cache = lalibeFermStateCache(params.stochfourqfhparam.prop_param.fermact, params.named_obj.gauge_id, u);
+	    Handle<FermionAction<T, P, Q>> action = ferm_cache.action;
+	    Handle<FermState<T, P, Q>> action_state = ferm_cache.state;
 	    QDPIO::cout<<"Our action and fermion state are doing A-okay so far."<<std::endl;
 	    //Handle<SystemSolver<LatticeFermion>> solver = action->qprop(action_state, params.stochfourqfhparam.prop_param.invParam);
 	    //Above is for a single fermion, but we want to loop over spin/color and solve for the full propagator.
@@ -271,26 +277,10 @@ namespace Chroma
 	    LatticePropagator fh_prop_solution;
 
 	    //Here's where the actual noisy stuff happens.
+	    //Vector vector_number is made directly from the seed, no replay of the vectors before it.
 	    LatticeComplex vec ;
-	    Seed ran_seed;
-	    QDP::RNG::savern(ran_seed);
-
-	    // Set the seed to desired value
-	    QDP::RNG::setrn(params.stochfourqfhparam.ran_seed);
-
-	    for(int current_vec = 0; current_vec < params.stochfourqfhparam.vector_number; current_vec++)
-	    {
-	      int N  = params.stochfourqfhparam.ZN;
-	      LatticeReal rnd1, theta;
-	      // twopi defined in chroma/lib/chromabase.h
-	      Real twopiN = Chroma::twopi / N;
-	      random(rnd1);
-	      theta = twopiN * floor(N*rnd1);
-	      vec = cmplx(cos(theta),sin(theta));
-	    }
-
-	    //restore the seed
-	    QDP::RNG::setrn(ran_seed);
+	    Handle<LalibeNoiseSource> noise = lalibeZNNoiseSource(params.stochfourqfhparam.noise_engine, params.stochfourqfhparam.ran_seed, params.stochfourqfhparam.ZN);
+	    (*noise)(params.stochfourqfhparam.vector_number, vec);
 
 	    //conjugate noise if needed
 	    //This may have to be current dependent, but we'll change that later.
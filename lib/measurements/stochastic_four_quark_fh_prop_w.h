@@ -52,6 +52,7 @@ namespace Chroma
 	int vector_number;		      //starting vector number, to simplify things, this should be 1 for a new gauge cfg
 	Seed ran_seed; 			      //seed value, keeping this the same for stoch_fh and disco is crucial!
 	int ZN;                               //the type of random noise
+	std::string noise_engine;              //"qdp" (default) or "counter", must match between the ZN inversion and its contractions
 	bool conjugate;                       //this is a switch for conjugating the noise vector
       } stochfourqfhparam ;
 
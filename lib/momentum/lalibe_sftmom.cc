@@ -28,7 +28,7 @@
 //  Added a default constructor.
 //
 //  Revision 3.2  2006/08/30 02:10:19  edwards
-//  Technically a bug fix. The test for a zero_offset should only be in directions
+//  Technically a bug fix. The test for a zero_offset should only be in directions
 //  not in the fourier transform. E.g., there was a missing test of mu==decay_dir.
 //
 //  Revision 3.1  2006/08/19 19:29:33  flemingg
@@ -102,6 +102,9 @@
 #include "util/ft/single_phase.h"
 #include "qdp_util.h"                 // part of QDP++, for crtesn()
 
+#include <algorithm>
+#include <map>
+
 namespace Chroma 
 {
 
@@ -118,9 +121,151 @@ namespace Chroma
   };
 
 
+  LalibeSftMode lalibeSftModeFromString(const std::string& mode)
+  {
+    if (mode == "phases")
+      return SFT_PHASES;
+    else if (mode == "compact")
+      return SFT_COMPACT;
+    else if (mode == "fft")
+      return SFT_FFT;
+
+    QDPIO::cerr << "LalibeSftMom: unknown ft_mode " << mode
+		<< ", options are phases, compact and fft" << std::endl;
+    QDP_abort(1);
+    return SFT_PHASES;
+  }
+
+  std::string lalibeSftModeToString(LalibeSftMode mode)
+  {
+    switch (mode)
+    {
+    case SFT_COMPACT:
+      return "compact";
+    case SFT_FFT:
+      return "fft";
+    default:
+      return "phases";
+    }
+  }
+
+
   // Anonymous namespace
   namespace
   {
+    //! Site value of a lattice complex or real field as a std::complex<double>
+    template<typename W>
+    inline std::complex<double> siteValue(const OLattice<PScalar<PScalar<RComplex<W> > > >& cf, int site)
+    {
+      return std::complex<double>(cf.elem(site).elem().elem().real(),
+				  cf.elem(site).elem().elem().imag());
+    }
+
+    template<typename W>
+    inline std::complex<double> siteValue(const OLattice<PScalar<PScalar<RScalar<W> > > >& cf, int site)
+    {
+      return std::complex<double>(cf.elem(site).elem().elem().elem(), 0.0);
+    }
+
+    //! Mixed radix 1D FFT of one length, unnormalized with exp(+2 pi i k x / n).
+    //! The digit reversal and the twiddles are worked out once per length.
+    class FftPlan
+    {
+    public:
+      explicit FftPlan(int n_ = 1) : n(n_)
+	{
+	  const double twopi = 6.283185307179586476925286;
+
+	  // smallest factors first; whatever prime is left over is done as a plain DFT
+	  int m = n;
+	  for (int r = 2; r*r <= m; ++r)
+	    while (m % r == 0) {
+	      radix.push_back(r);
+	      m /= r;
+	    }
+	  if (m > 1)
+	    radix.push_back(m);
+
+	  twiddle.resize(n);
+	  for (int k = 0; k < n; ++k) {
+	    double arg = twopi * double(k) / double(n);
+	    twiddle[k] = std::complex<double>(cos(arg), sin(arg));
+	  }
+
+	  // a[x] starts at its mixed radix digit reversed position
+	  perm.resize(n);
+	  for (int x = 0; x < n; ++x) {
+	    int rem = x, block = n, pos = 0;
+	    for (unsigned int f = 0; f < radix.size(); ++f) {
+	      block /= radix[f];
+	      pos += (rem % radix[f]) * block;
+	      rem /= radix[f];
+	    }
+	    perm[x] = pos;
+	  }
+	}
+
+      //! Work per transformed element, to compare against a direct sum
+      int cost() const
+	{
+	  int c = 0;
+	  for (unsigned int f = 0; f < radix.size(); ++f)
+	    c += radix[f];
+	  return c;
+	}
+
+      //! In place transform of a[0..n), scratch is resized as needed
+      void transform(std::complex<double>* a, std::vector<std::complex<double>>& scratch) const
+	{
+	  if (n <= 1)
+	    return;
+	  scratch.resize(n);
+
+	  for (int x = 0; x < n; ++x)
+	    scratch[perm[x]] = a[x];
+
+	  // combine radix[f] neighbouring transforms of length sub into one of
+	  // length len, innermost factor first
+	  std::complex<double>* in = scratch.data();
+	  std::complex<double>* out = a;
+	  int sub = 1;
+	  for (int f = radix.size()-1; f >= 0; --f) {
+	    const int r = radix[f];
+	    const int len = sub*r;
+	    const int step = n / len;
+	    for (int b = 0; b < n; b += len)
+	      for (int k = 0; k < len; ++k) {
+		std::complex<double> acc(0.0, 0.0);
+		for (int s = 0; s < r; ++s)
+		  acc += twiddle[(s*k % len) * step] * in[b + s*sub + k % sub];
+		out[b + k] = acc;
+	      }
+	    std::swap(in, out);
+	    sub = len;
+	  }
+
+	  if (in != a)
+	    for (int x = 0; x < n; ++x)
+	      a[x] = in[x];
+	}
+
+    private:
+      int n;
+      std::vector<int> radix;
+      std::vector<int> perm;
+      std::vector<std::complex<double>> twiddle;
+    };
+
+    //! One plan per length, made the first time that length is transformed
+    const FftPlan& fftPlan(int n)
+    {
+      static std::map<int, FftPlan> plans;
+      std::map<int, FftPlan>::iterator it = plans.find(n);
+      if (it == plans.end())
+	it = plans.insert(std::make_pair(n, FftPlan(n))).first;
+      return it->second;
+    }
+
     //! Function object used for constructing the time-slice set
     class TimeSliceFunc : public SetFunc
     {
@@ -136,6 +281,22 @@ namespace Chroma
 
       int dir_decay;
     };
+
+    //! Function object splitting the lattice into a window of time slices (color 0) and the rest
+    class TimeWindowFunc : public SetFunc
+    {
+    public:
+      TimeWindowFunc(int dir, const std::vector<bool>& in_window_): dir_decay(dir), in_window(in_window_) {}
+
+      int operator() (const multi1d<int>& coordinate) const
+	{ return in_window[coordinate[dir_decay]] ? 0 : 1; }
+
+      int numSubsets() const { return 2; }
+
+    private:
+      int dir_decay;
+      std::vector<bool> in_window;
+    };
   }
 
   int
@@ -203,18 +364,31 @@ namespace Chroma
   }*/
   
   //Arjun copied function above, but with origin offset.
-  LalibeSftMom::LalibeSftMom(const multi2d<int> & moms , multi1d<int> origin_offset_, int j_decay)
+  LalibeSftMom::LalibeSftMom(const multi2d<int> & moms , multi1d<int> origin_offset_, int j_decay,
+			     LalibeSftMode mode_)
   {
     decay_dir = j_decay;
 		
     multi1d<int> orig = origin_offset_;
 
 
-    init(0, orig, orig , false, decay_dir);
+    init(0, orig, orig , false, decay_dir, mode_);
 		
     num_mom = moms.size2();
     mom_list = moms;
 
+    mom_degen.resize(num_mom);
+    mom_degen = 0;
+
+    if (mode != SFT_PHASES)
+    {
+      compact_terms.clear();
+      for (int m = 0 ; m < num_mom ; ++m)
+	addCompactTerm(m, mom_list[m]);
+      finishCompact();
+      return;
+    }
+
     phases.resize(num_mom);
 
 
@@ -226,7 +400,7 @@ namespace Chroma
   }
 
   LalibeSftMom::LalibeSftMom(int mom2_max, multi1d<int> origin_offset_, bool avg_mom,
-                 int j_decay)
+                 int j_decay, LalibeSftMode mode_)
   {
     multi1d<int> mom_off;
 
@@ -237,7 +411,7 @@ namespace Chroma
     }
     mom_off = 0 ;
 
-    init(mom2_max, origin_offset_, mom_off, avg_mom, j_decay) ;
+    init(mom2_max, origin_offset_, mom_off, avg_mom, j_decay, mode_) ;
   }
 
   int
@@ -259,12 +433,16 @@ namespace Chroma
 
   void
   LalibeSftMom::init(int mom2_max, multi1d<int> origin_off, multi1d<int> mom_off,
-	       bool avg_mom, int j_decay)
+	       bool avg_mom, int j_decay, LalibeSftMode mode_)
   {
     decay_dir     = j_decay;    // private copy
     origin_offset = origin_off; // private copy
     mom_offset    = mom_off;    // private copy
     avg_equiv_mom = avg_mom;    // private copy
+    mode          = mode_;      // private copy
+    cached_mom    = -1;
+    has_window    = false;
+    compact_terms.clear();
 
     sft_set.make(TimeSliceFunc(j_decay)) ;
 
@@ -358,13 +536,18 @@ namespace Chroma
 
     // Now resize and initialize the Fourier phase table.  Then, loop over
     // allowed momenta, optionally averaging over equivalent momenta.
-    phases.resize(num_mom) ;
-    phases = 0. ;
-
-    // Coordinates for sink momenta
-    multi1d<LatticeInteger> my_coord(Nd);
-    for (int mu=0; mu < Nd; ++mu)
-      my_coord[mu] = Layout::latticeCoordinate(mu);
+    // In compact and fft mode no lattice phases are kept, only the list of
+    // momenta feeding each mom_num.
+    multi1d<LatticeInteger> my_coord;
+    if (mode == SFT_PHASES) {
+      phases.resize(num_mom) ;
+      phases = 0. ;
+
+      // Coordinates for sink momenta
+      my_coord.resize(Nd);
+      for (int mu=0; mu < Nd; ++mu)
+	my_coord[mu] = Layout::latticeCoordinate(mu);
+    }
 
     // Keep track of |mom| degeneracy for averaging
     mom_degen.resize(num_mom);
@@ -449,6 +632,12 @@ namespace Chroma
 	}
       } // end if (avg_equiv_mom)
 
+      if (mode != SFT_PHASES) {
+	addCompactTerm(mom_num, mom) ;
+	++mom_num ;
+	continue ;
+      }
+
       //
       // Build the phase. 
       // RGE: the origin_offset works with or without momentum averaging
@@ -476,13 +665,384 @@ namespace Chroma
 
     // Finish averaging
     // Momentum averaging works even in the presence of an origin_offset
-    if (avg_equiv_mom) {
+    if (mode != SFT_PHASES) {
+      if (avg_equiv_mom) {
+	for (unsigned int k=0; k < compact_terms.size(); ++k)
+	  compact_terms[k].weight = 1.0 / mom_degen[compact_terms[k].mom_num] ;
+      }
+      finishCompact() ;
+    } else if (avg_equiv_mom) {
       for (int mom_num=0; mom_num < num_mom; ++mom_num)
 	phases[mom_num] /= mom_degen[mom_num] ;
     }
   }
 
 
+  void
+  LalibeSftMom::addCompactTerm(int mom_num, const multi1d<int>& mom)
+  {
+    CompactTerm term;
+    term.mom_num = mom_num;
+    term.weight  = 1.0;
+    term.mom     = mom;
+    compact_terms.push_back(term);
+  }
+
+
+  void
+  LalibeSftMom::finishCompact()
+  {
+    const double twopi = 6.283185307179586476925286;
+
+    fourier_dirs.clear();
+    for (int mu = 0; mu < Nd; ++mu)
+      if (mu != decay_dir)
+	fourier_dirs.push_back(mu);
+
+    // one row of exp(i 2 pi p (x - x0) / L) per distinct momentum component
+    // and direction; the terms point at their rows by offset
+    phase_tables.assign(fourier_dirs.size(), std::vector<std::complex<double>>());
+    table_moms.assign(fourier_dirs.size(), std::vector<int>());
+
+    for (unsigned int k = 0; k < compact_terms.size(); ++k) {
+      CompactTerm& term = compact_terms[k];
+      term.row.resize(fourier_dirs.size());
+      term.comp.resize(fourier_dirs.size());
+      term.fft_phase = std::complex<double>(1.0, 0.0);
+
+      for (unsigned int j = 0; j < fourier_dirs.size(); ++j) {
+	int mu = fourier_dirs[j];
+	int L = Layout::lattSize()[mu];
+	int p = term.mom[j];
+
+	unsigned int row = 0;
+	while (row < table_moms[j].size() && table_moms[j][row] != p)
+	  ++row;
+
+	if (row == table_moms[j].size()) {
+	  table_moms[j].push_back(p);
+	  // the fft mode tables are about the lattice origin, like the fft itself
+	  int x0 = (mode == SFT_COMPACT) ? origin_offset[mu] : 0;
+	  for (int x = 0; x < L; ++x) {
+	    double arg = twopi * double(p) * double(x - x0) / double(L);
+	    phase_tables[j].push_back(std::complex<double>(cos(arg), sin(arg)));
+	  }
+	}
+
+	term.comp[j] = row;
+	term.row[j] = row * L;
+
+	// the fft transforms about the lattice origin, the offset goes in afterwards
+	double arg = -twopi * double(p) * double(origin_offset[mu]) / double(L);
+	term.fft_phase *= std::complex<double>(cos(arg), sin(arg));
+      }
+    }
+
+    // the rectangular block of the lattice owned by this node
+    box_origin.resize(Nd);
+    box_extent.resize(Nd);
+    for (int mu = 0; mu < Nd; ++mu) {
+      box_extent[mu] = Layout::subgridLattSize()[mu];
+      box_origin[mu] = Layout::nodeCoord()[mu] * box_extent[mu];
+    }
+
+    // the coordinates the site sweeps need, worked out once per local site
+    // instead of a Layout::siteCoords() call per site and projection
+    const int n_dir = fourier_dirs.size();
+    const int n_site = Layout::sitesOnNode();
+    const int node = Layout::nodeNumber();
+    const bool has_time = (decay_dir >= 0) && (decay_dir < Nd);
+    site_t.resize(n_site);
+    site_x.resize(n_site*n_dir);
+    site_box.resize(n_site);
+    for (int site = 0; site < n_site; ++site) {
+      multi1d<int> coord = Layout::siteCoords(node, site);
+
+      site_t[site] = has_time ? coord[decay_dir] : 0;
+      for (int j = 0; j < n_dir; ++j)
+	site_x[site*n_dir + j] = coord[fourier_dirs[j]];
+
+      int idx = 0;
+      for (int mu = Nd-1; mu >= 0; --mu)
+	idx = idx*box_extent[mu] + (coord[mu] - box_origin[mu]);
+      site_box[site] = idx;
+    }
+  }
+
+
+  const LatticeComplex&
+  LalibeSftMom::compactPhase(int mom_num) const
+  {
+    if (cached_mom == mom_num)
+      return phase_cache;
+
+    const Real twopi = 6.283185307179586476925286;
+
+    phase_cache = zero;
+    for (unsigned int k = 0; k < compact_terms.size(); ++k) {
+      const CompactTerm& term = compact_terms[k];
+      if (term.mom_num != mom_num)
+	continue;
+
+      LatticeReal p_dot_x = zero;
+      for (unsigned int j = 0; j < fourier_dirs.size(); ++j) {
+	int mu = fourier_dirs[j];
+	p_dot_x += LatticeReal(Layout::latticeCoordinate(mu) - origin_offset[mu]) * twopi *
+	  Real(term.mom[j]) / Layout::lattSize()[mu];
+      }
+
+      phase_cache += Real(term.weight) * cmplx(cos(p_dot_x), sin(p_dot_x));
+    }
+
+    cached_mom = mom_num;
+    return phase_cache;
+  }
+
+
+  template<typename T>
+  void
+  LalibeSftMom::gatherBox(const T& cf, std::vector<std::complex<double>>& box) const
+  {
+    int box_vol = 1;
+    for (int mu = 0; mu < Nd; ++mu)
+      box_vol *= box_extent[mu];
+    box.assign(box_vol, std::complex<double>(0.0, 0.0));
+
+    const Subset& sites = getWindow();
+    const int* site_table = sites.siteTable().slice();
+    const int n_site = sites.numSiteTable();
+#pragma omp parallel for
+    for (int j_site = 0; j_site < n_site; ++j_site) {
+      const int site = site_table[j_site];
+      box[site_box[site]] = siteValue(cf, site);
+    }
+  }
+
+
+  template<typename T>
+  multi2d<DComplex>
+  LalibeSftMom::sftPhases(const T& cf) const
+  {
+    multi2d<DComplex> hsum(num_mom, sft_set.numSubsets()) ;
+
+    if (!has_window) {
+      for (int mom_num=0; mom_num < num_mom; ++mom_num)
+	hsum[mom_num] = sumMulti(phases[mom_num]*cf, sft_set) ;
+
+      return hsum ;
+    }
+
+    // only the time slices of the window are summed, the rest stay zero
+    hsum = zero;
+    for (int t = 0; t < sft_set.numSubsets(); ++t) {
+      if (!in_window[t])
+	continue;
+      for (int mom_num=0; mom_num < num_mom; ++mom_num)
+	hsum[mom_num][t] = sum(phases[mom_num]*cf, sft_set[t]);
+    }
+
+    return hsum ;
+  }
+
+
+  template<typename T>
+  multi1d< multi2d<DComplex> >
+  LalibeSftMom::sftSites(const std::vector<const T*>& cfs, int subset_color) const
+  {
+    const int length = sft_set.numSubsets();
+    const int n_cf = cfs.size();
+    const int n_dir = fourier_dirs.size();
+    const int n_sum = n_cf*num_mom*length;
+
+    // Local partial sums, [(cf*num_mom + mom_num)*length + t]
+    std::vector<std::complex<double>> local_sum(n_sum, std::complex<double>(0.0, 0.0));
+
+    if (mode == SFT_FFT) {
+      // transform each field's local block and pick out the momenta
+      std::vector<std::complex<double>> box;
+      for (int c = 0; c < n_cf; ++c) {
+	gatherBox(*cfs[c], box);
+	fftProject(box, subset_color, &local_sum[c*num_mom*length]);
+      }
+    } else {
+      // Each site of the time window is visited once: its phases for every
+      // momentum are formed from the 1D tables and applied to every field.
+      // The threads each fill their own partial sums, added up at the end.
+      const Subset& sites = getWindow();
+      const int* site_table = sites.siteTable().slice();
+      const int n_site = sites.numSiteTable();
+
+#pragma omp parallel
+      {
+	std::vector<std::complex<double>> part(n_sum, std::complex<double>(0.0, 0.0));
+	std::vector<std::complex<double>> site_phase(num_mom);
+
+#pragma omp for
+	for (int j_site = 0; j_site < n_site; ++j_site) {
+	  const int site = site_table[j_site];
+	  const int t = site_t[site];
+	  if ((subset_color >= 0) && (t != subset_color))
+	    continue;
+
+	  const int* x = &site_x[site*n_dir];
+	  std::fill(site_phase.begin(), site_phase.end(), std::complex<double>(0.0, 0.0));
+	  for (unsigned int k = 0; k < compact_terms.size(); ++k) {
+	    const CompactTerm& term = compact_terms[k];
+	    std::complex<double> ph(term.weight, 0.0);
+	    for (int j = 0; j < n_dir; ++j)
+	      ph *= phase_tables[j][term.row[j] + x[j]];
+	    site_phase[term.mom_num] += ph;
+	  }
+
+	  for (int c = 0; c < n_cf; ++c) {
+	    std::complex<double> val = siteValue(*cfs[c], site);
+	    std::complex<double>* dest = &part[c*num_mom*length + t];
+	    for (int mom_num = 0; mom_num < num_mom; ++mom_num)
+	      dest[mom_num*length] += val * site_phase[mom_num];
+	  }
+	}
+
+#pragma omp critical
+	for (int i = 0; i < n_sum; ++i)
+	  local_sum[i] += part[i];
+      }
+    }
+
+    // One global reduction for all fields, momenta and time slices
+    QDPInternal::globalSumArray(reinterpret_cast<double*>(local_sum.data()), 2*local_sum.size());
+
+    multi1d< multi2d<DComplex> > hsum(n_cf);
+    for (int c = 0; c < n_cf; ++c) {
+      hsum[c].resize(num_mom, length);
+      for (int mom_num = 0; mom_num < num_mom; ++mom_num)
+	for (int t = 0; t < length; ++t) {
+	  const std::complex<double>& z = local_sum[(c*num_mom + mom_num)*length + t];
+	  hsum[c][mom_num][t] = cmplx(Real64(z.real()), Real64(z.imag()));
+	}
+    }
+
+    return hsum;
+  }
+
+
+  void
+  LalibeSftMom::fftProject(std::vector<std::complex<double>>& box, int subset_color,
+			   std::complex<double>* dest) const
+  {
+    const int length = sft_set.numSubsets();
+    const bool has_time = (decay_dir >= 0) && (decay_dir < Nd);
+
+    // Row by row transform, one Fourier direction at a time, keeping only the
+    // momentum components that are actually requested, so the block shrinks
+    // (or at most keeps its size) with every direction done. When this node
+    // holds the whole direction and enough components are wanted, a row goes
+    // through the FFT. Otherwise the node only has a piece of every global
+    // row, and a direct sum over its ext[mu] sites onto the n_keep components
+    // is cheaper than padding the row out to the full length L.
+    std::vector<int> ext(box_extent);
+    std::vector<std::complex<double>> out;
+
+    for (unsigned int j = 0; j < fourier_dirs.size(); ++j) {
+      const int mu = fourier_dirs[j];
+      const int L = Layout::lattSize()[mu];
+      const int n_keep = table_moms[j].size();
+      const int e = ext[mu];
+      const int x0 = box_origin[mu];
+
+      int inner = 1, outer = 1;
+      for (int nu = 0; nu < mu; ++nu) inner *= ext[nu];
+      for (int nu = mu+1; nu < Nd; ++nu) outer *= ext[nu];
+
+      const FftPlan& plan = fftPlan(L);
+      const bool use_fft = (e == L) && (n_keep > plan.cost());
+
+      std::vector<int> keep(n_keep);
+      for (int r = 0; r < n_keep; ++r)
+	keep[r] = ((table_moms[j][r] % L) + L) % L;
+
+      out.assign(inner*n_keep*outer, std::complex<double>(0.0, 0.0));
+
+      // with a time window, rows on time slices outside of it are all zero
+      // and are left out of the transform
+      int t_stride = 0;
+      if (has_window && has_time) {
+	t_stride = 1;
+	if (decay_dir < mu)
+	  for (int nu = 0; nu < decay_dir; ++nu) t_stride *= ext[nu];
+	else
+	  for (int nu = mu+1; nu < decay_dir; ++nu) t_stride *= ext[nu];
+      }
+
+      const int n_row = inner*outer;
+#pragma omp parallel
+      {
+	std::vector<std::complex<double>> line(e), scratch;
+
+#pragma omp for
+	for (int row = 0; row < n_row; ++row) {
+	  const int i = row % inner;
+	  const int o = row / inner;
+	  if (t_stride > 0) {
+	    int t_loc = ((decay_dir < mu) ? i : o) / t_stride % ext[decay_dir];
+	    if (!in_window[box_origin[decay_dir] + t_loc])
+	      continue;
+	  }
+
+	  for (int x = 0; x < e; ++x)
+	    line[x] = box[i + inner*(x + e*o)];
+
+	  if (use_fft) {
+	    plan.transform(line.data(), scratch);
+	    for (int r = 0; r < n_keep; ++r)
+	      out[i + inner*(r + n_keep*o)] = line[keep[r]];
+	  } else {
+	    for (int r = 0; r < n_keep; ++r) {
+	      const std::complex<double>* ph = &phase_tables[j][r*L + x0];
+	      std::complex<double> acc(0.0, 0.0);
+	      for (int x = 0; x < e; ++x)
+		acc += ph[x] * line[x];
+	      out[i + inner*(r + n_keep*o)] = acc;
+	    }
+	  }
+	}
+      }
+
+      box.swap(out);
+      ext[mu] = n_keep;
+    }
+
+    // box is now indexed by momentum component in the Fourier directions and
+    // by local time; hand every term its entry
+    std::vector<int> stride(Nd);
+    stride[0] = 1;
+    for (int mu = 1; mu < Nd; ++mu)
+      stride[mu] = stride[mu-1]*ext[mu-1];
+
+    const int n_t = has_time ? ext[decay_dir] : 1;
+
+    for (unsigned int k = 0; k < compact_terms.size(); ++k) {
+      const CompactTerm& term = compact_terms[k];
+
+      int idx = 0;
+      for (unsigned int j = 0; j < fourier_dirs.size(); ++j)
+	idx += term.comp[j]*stride[fourier_dirs[j]];
+
+      std::complex<double> factor = term.weight * term.fft_phase;
+
+      for (int t_loc = 0; t_loc < n_t; ++t_loc) {
+	int t = has_time ? box_origin[decay_dir] + t_loc : 0;
+	if ((subset_color >= 0) && (t != subset_color))
+	  continue;
+	if (has_window && has_time && !in_window[t])
+	  continue;
+
+	int t_idx = has_time ? t_loc*stride[decay_dir] : 0;
+	dest[term.mom_num*length + t] += factor * box[idx + t_idx];
+      }
+    }
+  }
+
+
   // Canonically order an array of momenta
   /* \return abs(mom[0]) >= abs(mom[1]) >= ... >= abs(mom[mu]) >= ... >= 0 */
   multi1d<int> 
@@ -545,20 +1105,43 @@ namespace Chroma
     return -1;
   }
 
+  void
+  LalibeSftMom::setTimeWindow(int t_start, int t_extent)
+  {
+    if ((decay_dir < 0) || (decay_dir >= Nd)) {
+      QDPIO::cerr << "LalibeSftMom: a time window needs a decay direction" << std::endl;
+      QDP_abort(1);
+    }
+
+    const int Lt = Layout::lattSize()[decay_dir];
+    if ((t_extent <= 0) || (t_extent >= Lt)) {
+      has_window = false;
+      return;
+    }
+
+    in_window.assign(Lt, false);
+    for (int dt = 0; dt < t_extent; ++dt)
+      in_window[((t_start + dt) % Lt + Lt) % Lt] = true;
+
+    window_set.make(TimeWindowFunc(decay_dir, in_window));
+    has_window = true;
+  }
+
   multi2d<DComplex>
   LalibeSftMom::sft(const LatticeComplex& cf) const
   {
-    multi2d<DComplex> hsum(num_mom, sft_set.numSubsets()) ;
-
-    for (int mom_num=0; mom_num < num_mom; ++mom_num)
-      hsum[mom_num] = sumMulti(phases[mom_num]*cf, sft_set) ;
+    if (mode != SFT_PHASES)
+      return sftSites(std::vector<const LatticeComplex*>(1, &cf), -1)[0];
 
-    return hsum ;
+    return sftPhases(cf);
   }
 
   multi2d<DComplex>
   LalibeSftMom::sft(const LatticeComplex& cf, int subset_color) const
   {
+    if (mode != SFT_PHASES)
+      return sftSites(std::vector<const LatticeComplex*>(1, &cf), subset_color)[0];
+
     int length = sft_set.numSubsets();
     multi2d<DComplex> hsum(num_mom, length);
 
@@ -574,17 +1157,18 @@ namespace Chroma
   multi2d<DComplex>
   LalibeSftMom::sft(const LatticeReal& cf) const
   {
-    multi2d<DComplex> hsum(num_mom, sft_set.numSubsets()) ;
+    if (mode != SFT_PHASES)
+      return sftSites(std::vector<const LatticeReal*>(1, &cf), -1)[0];
 
-    for (int mom_num=0; mom_num < num_mom; ++mom_num)
-      hsum[mom_num] = sumMulti(phases[mom_num]*cf, sft_set) ;
-
-    return hsum ;
+    return sftPhases(cf);
   }
 
   multi2d<DComplex>
   LalibeSftMom::sft(const LatticeReal& cf, int subset_color) const
   {
+    if (mode != SFT_PHASES)
+      return sftSites(std::vector<const LatticeReal*>(1, &cf), subset_color)[0];
+
     int length = sft_set.numSubsets();
     multi2d<DComplex> hsum(num_mom, length);
 
@@ -597,21 +1181,63 @@ namespace Chroma
     return hsum ;
   }
 
+  multi1d< multi2d<DComplex> >
+  LalibeSftMom::sft(const multi1d<LatticeComplex>& cfs) const
+  {
+    std::vector<const LatticeComplex*> cf_ptrs(cfs.size());
+    for (int c = 0; c < cfs.size(); ++c)
+      cf_ptrs[c] = &cfs[c];
+
+    return sft(cf_ptrs);
+  }
+
+  multi1d< multi2d<DComplex> >
+  LalibeSftMom::sft(const std::vector<const LatticeComplex*>& cfs) const
+  {
+    if (mode != SFT_PHASES)
+      return sftSites(cfs, -1);
+
+    // the threaded sumMulti does better than a site sweep over the phase fields
+    multi1d< multi2d<DComplex> > hsum(cfs.size());
+    for (int c = 0; c < hsum.size(); ++c)
+      hsum[c] = sftPhases(*cfs[c]);
+
+    return hsum;
+  }
+
+#if BASE_PRECISION==64
+  multi1d< multi2d<DComplex> >
+  LalibeSftMom::sft(const std::vector<const LatticeComplexF*>& cfs) const
+  {
+    if (mode != SFT_PHASES)
+      return sftSites(cfs, -1);
+
+    multi1d< multi2d<DComplex> > hsum(cfs.size());
+    for (int c = 0; c < hsum.size(); ++c) {
+      LatticeComplex cf = *cfs[c];
+      hsum[c] = sftPhases(cf);
+    }
+
+    return hsum;
+  }
+#endif
+
 #if BASE_PRECISION==32
   multi2d<DComplex>
   LalibeSftMom::sft(const LatticeComplexD& cf) const
   {
-    multi2d<DComplex> hsum(num_mom, sft_set.numSubsets()) ;
-
-    for (int mom_num=0; mom_num < num_mom; ++mom_num)
-      hsum[mom_num] = sumMulti(phases[mom_num]*cf, sft_set) ;
+    if (mode != SFT_PHASES)
+      return sftSites(std::vector<const LatticeComplexD*>(1, &cf), -1)[0];
 
-    return hsum ;
+    return sftPhases(cf);
   }
 
   multi2d<DComplex>
   LalibeSftMom::sft(const LatticeComplexD& cf, int subset_color) const
   {
+    if (mode != SFT_PHASES)
+      return sftSites(std::vector<const LatticeComplexD*>(1, &cf), subset_color)[0];
+
     int length = sft_set.numSubsets();
     multi2d<DComplex> hsum(num_mom, length);
 
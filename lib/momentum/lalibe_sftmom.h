@@ -10,9 +10,34 @@
 
 #include "chromabase.h"
 
+#include <complex>
+#include <string>
+#include <vector>
+
 namespace Chroma 
 {
 
+  //! How LalibeSftMom projects onto momenta
+  /*!
+   * \ingroup ft
+   *
+   * SFT_PHASES keeps one lattice phase field per momentum (the chroma SftMom way).
+   * SFT_COMPACT keeps only one 1D exponential table per spatial direction and
+   * projects all momenta in a single pass over the local sites.
+   * SFT_FFT transforms each node's block of the lattice direction by direction,
+   * keeping only the requested momentum components. A direction the node holds
+   * whole goes through a 1D FFT, so its cost no longer grows with the number of
+   * momenta; a split direction is summed directly over the node's sites. Use it
+   * for large p2_max.
+   */
+  enum LalibeSftMode { SFT_PHASES, SFT_COMPACT, SFT_FFT };
+
+  //! Map the XML ft_mode string ("phases", "compact" or "fft") onto a LalibeSftMode
+  LalibeSftMode lalibeSftModeFromString(const std::string& mode);
+
+  //! And back, for writing XML
+  std::string lalibeSftModeToString(LalibeSftMode mode);
+
   //! Param struct for LalibeSftMom
   /*!
    * \ingroup ft
@@ -43,11 +68,12 @@ namespace Chroma
     //LalibeSftMom(const multi2d<int> & moms , int j_decay=-1);
     
     //! Arjun has added a mom_list with an origin_offset option.
-    LalibeSftMom(const multi2d<int> & moms , multi1d<int> origin_offset_, int j_decay=-1);
+    LalibeSftMom(const multi2d<int> & moms , multi1d<int> origin_offset_, int j_decay=-1,
+	   LalibeSftMode mode_=SFT_PHASES);
 
     //! Construct around some fixed origin_offset
     LalibeSftMom(int mom2_max, multi1d<int> origin_offset_,
-	   bool avg_equiv_mom_=false, int j_decay=-1) ;
+	   bool avg_equiv_mom_=false, int j_decay=-1, LalibeSftMode mode_=SFT_PHASES) ;
 
     //! Construct around some fixed origin_offset and mom_offset
     LalibeSftMom(int mom2_max, multi1d<int> origin_offset_, multi1d<int> mom_offset_,
@@ -90,9 +116,25 @@ namespace Chroma
     /*! \return abs(mom[0]) >= abs(mom[1]) >= ... >= abs(mom[mu]) >= ... >= 0 */
     multi1d<int> canonicalOrder(const multi1d<int>& mom) const;
 
+    //! Projection mode
+    LalibeSftMode getMode() const { return mode; }
+
+    //! Restrict all projections to the time slices t_start, ..., t_start+t_extent-1
+    //! (periodically wrapped); t_extent <= 0 or >= the time extent removes the window
+    void setTimeWindow(int t_start, int t_extent);
+
+    //! Is a time window set?
+    bool hasWindow() const { return has_window; }
+
+    //! The sites of the time window, or all sites without one. Fields only
+    //! need to be computed on this subset before they are projected
+    const Subset& getWindow() const { return has_window ? window_set[0] : all; }
+
     //! Return the phase for this particular momenta id
+    /*! In compact mode the phase is built on demand; the reference is only
+     *  valid until the next call with a different momentum id */
     const LatticeComplex& operator[](int mom_num) const
-      { return phases[mom_num]; }
+      { return (mode == SFT_PHASES) ? phases[mom_num] : compactPhase(mom_num); }
 
     //! Return the the multiplicity for this momenta id.
     /*! Only nonzero if momentum averaging is turned on */
@@ -111,6 +153,19 @@ namespace Chroma
     //! Do a sumMulti(cf*phases,getSet()[my_subset])
     multi2d<DComplex> sft(const LatticeReal& cf, int subset_color) const;
 
+    //! Project a whole batch of fields. Compact and fft mode make one sweep over
+    //! the sites and one global sum for all of them, phases mode does a sumMulti per field.
+    /*! \return one [mom][t] array per field, in the order given */
+    multi1d< multi2d<DComplex> > sft(const multi1d<LatticeComplex>& cfs) const;
+
+    //! Same, for fields that are not stored together
+    multi1d< multi2d<DComplex> > sft(const std::vector<const LatticeComplex*>& cfs) const;
+
+#if BASE_PRECISION==64
+    //! Batch projection of single precision fields, the sums are still accumulated in double
+    multi1d< multi2d<DComplex> > sft(const std::vector<const LatticeComplexF*>& cfs) const;
+#endif
+
 #if BASE_PRECISION==32
     multi2d<DComplex> sft(const LatticeComplexD& cf) const;
     //! Do a sum(cf*phases,getSet()[my_subset])
@@ -121,7 +176,45 @@ namespace Chroma
     LalibeSftMom() {} // hide default constructor
 
     void init(int mom2_max, multi1d<int> origin_offset, multi1d<int> mom_offset,
-	      bool avg_mom_=false, int j_decay=-1);
+	      bool avg_mom_=false, int j_decay=-1, LalibeSftMode mode_=SFT_PHASES);
+
+    //! Compact/fft mode: register one momentum that contributes to mom_num
+    void addCompactTerm(int mom_num, const multi1d<int>& mom);
+
+    //! Compact/fft mode: finish the tables once all terms are registered
+    void finishCompact();
+
+    //! Compact/fft mode: build the phase of mom_num into phase_cache
+    const LatticeComplex& compactPhase(int mom_num) const;
+
+    //! Phases mode: sumMulti(cf*phases,getSet()), or one sum per time slice of the window
+    template<typename T>
+    multi2d<DComplex> sftPhases(const T& cf) const;
+
+    //! Compact/fft mode: project every field in cfs onto all momenta in one
+    //! threaded sweep over the local sites. subset_color < 0 means all time slices.
+    template<typename T>
+    multi1d< multi2d<DComplex> > sftSites(const std::vector<const T*>& cfs, int subset_color) const;
+
+    //! Fft mode: copy cf into a dense array over this node's block, x fastest
+    template<typename T>
+    void gatherBox(const T& cf, std::vector<std::complex<double>>& box) const;
+
+    //! Fft mode: transform the block and add every term into dest[mom_num*length + t]
+    void fftProject(std::vector<std::complex<double>>& box, int subset_color,
+		    std::complex<double>* dest) const;
+
+    //! One momentum contributing to a momentum id, as row offsets into the
+    //! per direction tables
+    struct CompactTerm
+    {
+      int mom_num;
+      double weight;
+      std::vector<int> row;                 //row offset into phase_tables, per direction
+      std::vector<int> comp;                //index into table_moms, per direction
+      std::complex<double> fft_phase;       //origin offset phase for the fft
+      multi1d<int> mom;
+    };
 
     multi2d<int> mom_list;
     bool         avg_equiv_mom;
@@ -132,6 +225,22 @@ namespace Chroma
     multi1d<LatticeComplex> phases;
     multi1d<int> mom_degen;
     Set sft_set;
+
+    LalibeSftMode mode;
+    std::vector<int> fourier_dirs;                                //lattice directions being transformed
+    std::vector<std::vector<std::complex<double>>> phase_tables;  //[direction][row*L + x], fft mode without the origin offset
+    std::vector<std::vector<int>> table_moms;                     //[direction][row] = momentum component
+    std::vector<CompactTerm> compact_terms;
+    std::vector<int> box_origin;                                  //this node's block of the lattice
+    std::vector<int> box_extent;
+    std::vector<int> site_t;                                      //[site], time slice of each local site
+    std::vector<int> site_x;                                      //[site*n_dir + j], coordinate along fourier_dirs[j]
+    std::vector<int> site_box;                                    //[site], index into this node's block
+    mutable LatticeComplex phase_cache;
+    mutable int cached_mom;
+    bool has_window;
+    std::vector<bool> in_window;                                  //[t], time slices that are projected
+    Set window_set;                                               //color 0 is the window
   };
 
 }  // end namespace Chroma
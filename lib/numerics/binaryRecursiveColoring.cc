@@ -27,7 +27,7 @@ namespace Chroma
 //   unsigned int twoTod;         /* 2^d */
 //   unsigned int *logPts;        /* log2(ptsPerDim) */
 //   char *RBorder;  /* Red-black order of a d-dim torus with 2 pts per dim */
-//   char *PTbits;   /* Bits for d coordinates of a point (d x maxlog2(Pts)) */
+//   unsigned int *RBdest; /* RBorder as integers */
 //} meshVars;
 
 /************************************************************************/
@@ -84,6 +84,7 @@ void findRBorder(struct meshVars *mesh) {
      else
 	destination = blacks++;
      int2bin(destination,&(mesh->RBorder[i*mesh->d]),mesh->d);
+     mesh->RBdest[i] = destination;
   }
 
   free(Cols);
@@ -101,6 +102,8 @@ void hierOrderSetUp(struct meshVars *mesh) {
   mesh->logPts = (unsigned int *)malloc(sizeof(unsigned int)*mesh->d);
     /* binary RB order as a char array 2^d \times d */
   mesh->RBorder = (char *)malloc(sizeof(char)*mesh->twoTod*mesh->d);  
+    /* the same order as integers, all hierOrderPoint needs */
+  mesh->RBdest = (unsigned int *)malloc(sizeof(unsigned int)*mesh->twoTod);
 
   /* Basic parameters */
   mesh->dmax = 0;
@@ -112,55 +115,35 @@ void hierOrderSetUp(struct meshVars *mesh) {
      while (n0 >>= 1) ++mesh->logPts[i];   /* finds log2(ptsPerDim(i)) */
   }
 
-  /* Auxiliary bit array for all d coordinates of a point (d x maxlog2(Pts)) */
-  mesh->PTbits = (char *)malloc(sizeof(char)*mesh->d*mesh->logPts[mesh->dmax]);
   
   /* Find the red-black ordering in binary for a 2 point d-dimensional torus */
   findRBorder(mesh);
 
 }
 /************************************************************************/
+/* Closed form of the original string based version: at every bit level l, from the
+ * least significant up, the level-l bits of the dimensions that still have that many bits
+ * index the red-black order of the 2^d torus, and the leading activeDims bits of that
+ * destination are appended to the result. Nothing is allocated, so it is cheap per site.
+ * Needs sum(logPts) <= 32, i.e. up to 2^32 padded lattice sites. */
 unsigned int hierOrderPoint(unsigned int *coord, struct meshVars *mesh) {
 
    unsigned int logmax = mesh->logPts[mesh->dmax];
-   unsigned int m,j,from,to,nbits,activeDims;
-   char *location_str;  /* contains up to logPts(dmax) strings of d bits*/
-   char *crossbits;     /* the d j-th bits of all coordinates */
-
-   location_str = (char *)malloc(sizeof(char)*mesh->d*logmax);
-   crossbits = (char *)malloc(sizeof(char)*mesh->d);  
-   
-   for (j=0; j<mesh->d; j++) {
-      /* bin form of coordinate j into j-th row of PTbits */
-      int2bin(coord[j], &(mesh->PTbits[j*logmax]), logmax);
-   }
-
-   nbits = 0; /* number of bits in location_str */
-
-   /* Go over the coordinate bit array from the least to most significant bit */
-   for (m=logmax; m>0 ; m--) {
+   unsigned int l,j,c,activeDims;
+   unsigned int result = 0;
 
-      /* Choose bits only from dimensions which can be subdivided further */
+   for (l=0; l<logmax; l++) {
+      /* Gather the level-l bits of the active dimensions, first one most significant */
+      c = 0;
       activeDims = 0;
-      for (j=0;j<mesh->d;j++) crossbits[j] = '0'; /* zero out crossbits */
-      from = 0;    /* starting at row 0 of PTbits */
       for (j=0;j<mesh->d;j++) {
-	 if (logmax-m < mesh->logPts[j]) 
-	    crossbits[activeDims++] = mesh->PTbits[from+m-1];      /* (j,m) */
-	 from += logmax; /* go to next (j+1) row in PTbits */
-      }
-      /* Take the first activeDims bits of the RBorder(crossbits) */
-      from = mesh->d*bin2int(crossbits,mesh->d);
-      to = from+activeDims;
-      for (j=from; j<to; j++) {
-        location_str[nbits++] = mesh->RBorder[j];
+	 if (l < mesh->logPts[j])
+	    c |= ((coord[j]>>l)&1u) << (mesh->d-1-activeDims++);
       }
+      /* Append the first activeDims bits of RBorder(c) */
+      result = (result << activeDims) | (mesh->RBdest[c] >> (mesh->d-activeDims));
    }
-
-   j = bin2int(location_str,nbits);
-   free(location_str);
-   free(crossbits);
-   return j;
+   return result;
 }
 /************************************************************************/
 /* Deallocate mesh info */
@@ -169,7 +152,7 @@ void freeMeshVars(struct meshVars *mesh)
    free(mesh->ptsPerDim);
    free(mesh->logPts);
    free(mesh->RBorder);
-   free(mesh->PTbits);
+   free(mesh->RBdest);
 }
 /************************************************************************
  * Hadamard vector related functions 
@@ -262,26 +245,16 @@ void hierPerm(struct meshVars *mesh, unsigned int *perm, unsigned int N)
       index2coord(i, mesh, coord);
       perm[i] = hierOrderPoint(coord, mesh);
    }*/
-  //I loop through all chroma coordinates here and pass them with a pointer.
-  unsigned int Nx = Layout::lattSize()[0];
-  unsigned int Ny = Layout::lattSize()[1];
-  unsigned int Nz = Layout::lattSize()[2];
-  unsigned int Nt = Layout::lattSize()[3];
-  for(unsigned int x = 0; x < Nx; x++)
-    for(unsigned int y = 0; y < Ny; y++)
-      for(unsigned int z = 0; z < Nz; z++)
-	for(unsigned int t = 0; t < Nz; z++)
-	{
-	  unsigned int coord[4] = {x, y, z, t};
-	  unsigned int* coordptr = coord;
-	  multi1d<int> chroma_coords;
-	  chroma_coords.resize(Nd);
-	  chroma_coords[0] = x; chroma_coords[1] = y; chroma_coords[2] = z; chroma_coords[3] = t;
-	  int i = Layout::linearSiteIndex(chroma_coords);
-	  perm[i] = hierOrderPoint(coordptr, mesh);
-	}
-
-
+  //Only the sites this node owns, N of them, perm is indexed by their node-local linear site index.
+  unsigned int coord[Nd];
+  const int node = Layout::nodeNumber();
+  for(unsigned int i = 0; i < N; i++)
+  {
+    multi1d<int> chroma_coords = Layout::siteCoords(node, i);
+    for(int mu = 0; mu < Nd; mu++)
+      coord[mu] = chroma_coords[mu];
+    perm[i] = hierOrderPoint(coord, mesh);
+  }
 }
 /************************************************************************/
 //Not using this for now, this will go in our inline measurements.
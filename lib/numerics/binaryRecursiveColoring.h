@@ -15,7 +15,7 @@ typedef struct meshVars {
    unsigned int twoTod;         /* 2^d */
    unsigned int *logPts;        /* log2(ptsPerDim) */
    char *RBorder;  /* Red-black order of a d-dim torus with 2 pts per dim */
-   char *PTbits;   /* Bits for d coordinates of a point (d x maxlog2(Pts)) */
+   unsigned int *RBdest; /* RBorder as integers */
 } meshVars;
 
 /* Turn integer to binary (chars 0 or 1). log(n) should be <= arraySize */
@@ -62,7 +62,7 @@ void index2coord(unsigned int i, struct meshVars *mesh, unsigned int *coord);
 
 /************************************************************************/
 /* Create permutation array for all i rows local on this processor */
-/* This is problem specific and SHOULD BE ADAPTED */
+/* N is Layout::sitesOnNode(), perm[i] is for node-local linear site index i */
 void hierPerm(struct meshVars *mesh, unsigned int *perm, unsigned int N);
 
 } //End the chroma namespace.
@@ -0,0 +1,104 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Batched solves of spin-color diluted noise sources
+ */
+
+#include "chromabase.h"
+#include "util/ferm/transf.h"
+#include "block_solve_w.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Chroma 
+{ 
+  namespace
+  {
+    //The pointers handed to the multi-rhs interface alias the multi1d elements, nothing is copied or freed.
+    template<typename T>
+    void no_delete(T*) {}
+
+    //Picked when the solver type has the multi-rhs call operator of newer chromas.
+    template<typename S, typename T>
+    auto mrhs_solve(const S& solver, multi1d<T>& psi, const multi1d<T>& chi,
+		    multi1d<SystemSolverResults_t>& res, int)
+      -> decltype(solver(std::declval<const std::vector<std::shared_ptr<T>>&>(),
+			 std::declval<const std::vector<std::shared_ptr<const T>>&>()), bool())
+    {
+      std::vector<std::shared_ptr<T>> psi_ptrs(psi.size());
+      std::vector<std::shared_ptr<const T>> chi_ptrs(chi.size());
+      for(int i = 0; i < psi.size(); i++)
+      {
+	psi_ptrs[i] = std::shared_ptr<T>(&psi[i], no_delete<T>);
+	chi_ptrs[i] = std::shared_ptr<const T>(&chi[i], no_delete<const T>);
+      }
+      auto block_res = solver(psi_ptrs, chi_ptrs);
+      for(int i = 0; i < res.size(); i++)
+	res[i] = block_res[i];
+      return true;
+    }
+
+    //Fallback when there is no multi-rhs interface to call.
+    template<typename S, typename T>
+    bool mrhs_solve(const S& solver, multi1d<T>& psi, const multi1d<T>& chi,
+		    multi1d<SystemSolverResults_t>& res, long)
+    {
+      return false;
+    }
+  }
+
+  void spin_color_dilute(const LatticeComplex& noise, multi1d<LatticeFermion>& chi, int offset)
+  {
+    for(int color_source(0);color_source<Nc;color_source++){
+      LatticeColorVector vec_srce = zero ;
+      pokeColor(vec_srce,noise,color_source) ;
+      for(int spin_source=0; spin_source < Ns; ++spin_source){
+	// Insert a ColorVector into spin index spin_source
+	// This only overwrites sections, so need to initialize first
+	chi[offset + color_source*Ns + spin_source] = zero;
+	CvToFerm(vec_srce, chi[offset + color_source*Ns + spin_source], spin_source);
+      }
+    }
+  }
+
+  void spin_color_to_prop(const multi1d<LatticeFermion>& psi, int offset, LatticePropagator& prop)
+  {
+    for(int color_source(0);color_source<Nc;color_source++)
+      for(int spin_source=0; spin_source < Ns; ++spin_source)
+	FermToProp(psi[offset + color_source*Ns + spin_source], prop, color_source, spin_source);
+  }
+
+  multi1d<SystemSolverResults_t> block_solve(const SystemSolver<LatticeFermion>& solver,
+					     multi1d<LatticeFermion>& psi,
+					     const multi1d<LatticeFermion>& chi,
+					     bool multi_rhs)
+  {
+    START_CODE();
+
+    if (psi.size() != chi.size())
+    {
+      QDPIO::cerr << __func__ << ": got " << chi.size() << " sources but room for " << psi.size() << " solutions" << std::endl;
+      QDP_abort(1);
+    }
+    multi1d<SystemSolverResults_t> res(chi.size());
+
+    if (multi_rhs)
+    {
+      if (mrhs_solve(solver, psi, chi, res, 0))
+      {
+	QDPIO::cout << "Solved " << chi.size() << " sources in one multi-rhs call" << std::endl;
+	END_CODE();
+	return res;
+      }
+      QDPIO::cout << "This chroma has no multi-rhs solver interface, solving the " << chi.size()
+		  << " sources one at a time" << std::endl;
+    }
+
+    for(int i = 0; i < chi.size(); i++)
+      res[i] = solver(psi[i], chi[i]);
+
+    END_CODE();
+    return res;
+  }
+}
@@ -0,0 +1,36 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Batched solves of spin-color diluted noise sources
+ */
+
+#ifndef __block_solve_w_h__
+#define __block_solve_w_h__
+
+#include "chromabase.h"
+#include "actions/ferm/invert/syssolver.h"
+
+namespace Chroma 
+{ 
+  //! Spin-color dilute a scalar noise into Nc*Ns fermion sources
+  /*!
+   * The source for (color, spin) lands in chi[offset + color*Ns + spin], chi must already be big enough.
+   */
+  void spin_color_dilute(const LatticeComplex& noise, multi1d<LatticeFermion>& chi, int offset);
+
+  //! Undo the dilution on the solutions, chi[offset + color*Ns + spin] goes to column (color, spin) of prop
+  void spin_color_to_prop(const multi1d<LatticeFermion>& psi, int offset, LatticePropagator& prop);
+
+  //! Solve psi[i] = M^-1 chi[i] for a whole batch of sources
+  /*!
+   * With multi_rhs the batch is handed to the solver's multi-right-hand-side interface in one call,
+   * when chroma's SystemSolver has one. Otherwise, or if the action's solver only has the default
+   * implementation, the sources are solved one after the other.
+   * psi must be sized like chi and carry the initial guesses.
+   */
+  multi1d<SystemSolverResults_t> block_solve(const SystemSolver<LatticeFermion>& solver,
+					     multi1d<LatticeFermion>& psi,
+					     const multi1d<LatticeFermion>& chi,
+					     bool multi_rhs);
+}
+
+#endif
@@ -0,0 +1,94 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Fermion actions and states kept alive across measurements
+ */
+
+#include "chromabase.h"
+#include "meas/inline/io/named_objmap.h"
+#include "actions/ferm/fermacts/fermact_factory_w.h"
+#include "fermion_state_cache_w.h"
+
+#include <functional>
+#include <set>
+#include <sstream>
+
+namespace Chroma 
+{ 
+  namespace
+  {
+    typedef LatticeFermion T;
+    typedef multi1d<LatticeColorMatrix> P;
+    typedef multi1d<LatticeColorMatrix> Q;
+
+    //! Named object ids of every cache made this run
+    std::set<std::string> cache_ids;
+
+    Double gauge_checksum(const multi1d<LatticeColorMatrix>& u)
+    {
+      Double check = zero;
+      for(int mu = 0; mu < u.size(); mu++)
+	check += sum(real(trace(u[mu])));
+      return check;
+    }
+
+    void build_cache(LalibeFermStateCache& cache, const GroupXML_t& fermact, const multi1d<LatticeColorMatrix>& u)
+    {
+      std::istringstream xml_action(fermact.xml);
+      XMLReader action_reader(xml_action);
+      cache.action = Handle<FermionAction<T, P, Q>>(TheFermionActionFactory::Instance().createObject(fermact.id, action_reader, fermact.path));
+      cache.state = Handle<FermState<T, P, Q>>(cache.action->createState(u));
+    }
+  }
+
+  LalibeFermStateCache& lalibeFermStateCache(const GroupXML_t& fermact, const std::string& gauge_id,
+					     const multi1d<LatticeColorMatrix>& u)
+  {
+    START_CODE();
+
+    const std::string key = fermact.id + "\n" + fermact.xml + "\n" + gauge_id;
+    std::ostringstream id;
+    id << "lalibe_ferm_state_" << std::hash<std::string>()(key);
+    std::string cache_id = id.str();
+    Double check = gauge_checksum(u);
+
+    if (TheNamedObjMap::Instance().check(cache_id))
+    {
+      LalibeFermStateCache& cache = TheNamedObjMap::Instance().getData<LalibeFermStateCache>(cache_id);
+      if (cache.key != key)
+      {
+	QDPIO::cerr << __func__ << ": hash collision on fermion state cache " << cache_id << std::endl;
+	QDP_abort(1);
+      }
+      if (toBool(cache.gauge_check == check))
+      {
+	QDPIO::cout << "Reusing fermion action and state from " << cache_id << std::endl;
+	END_CODE();
+	return cache;
+      }
+      QDPIO::cout << "Gauge field " << gauge_id << " changed since " << cache_id << " was made, rebuilding it" << std::endl;
+      build_cache(cache, fermact, u);
+      cache.gauge_check = check;
+      END_CODE();
+      return cache;
+    }
+
+    QDPIO::cout << "Making fermion action and state for " << cache_id << std::endl;
+    TheNamedObjMap::Instance().create<LalibeFermStateCache>(cache_id);
+    LalibeFermStateCache& cache = TheNamedObjMap::Instance().getData<LalibeFermStateCache>(cache_id);
+    cache.key = key;
+    cache.gauge_check = check;
+    build_cache(cache, fermact, u);
+    cache_ids.insert(cache_id);
+
+    END_CODE();
+    return cache;
+  }
+
+  void lalibeClearFermStateCaches()
+  {
+    for(std::set<std::string>::iterator it = cache_ids.begin(); it != cache_ids.end(); ++it)
+      if (TheNamedObjMap::Instance().check(*it))
+	TheNamedObjMap::Instance().erase(*it);
+    cache_ids.clear();
+  }
+}
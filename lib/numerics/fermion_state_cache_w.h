@@ -0,0 +1,43 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Fermion actions and states kept alive across measurements
+ */
+
+#ifndef __fermion_state_cache_w_h__
+#define __fermion_state_cache_w_h__
+
+#include "chromabase.h"
+#include "fermact.h"
+#include "io/xml_group_reader.h"
+
+#include <string>
+
+namespace Chroma 
+{ 
+  //! The fermion action and its state on one gauge field, shared between measurements
+  /*!
+   * One of these lives in the named object map for every (action, gauge field) pair a
+   * measurement has solved with, so later measurements with the same action skip the
+   * FermState construction. Nothing solver side is kept: no solvers, deflation spaces or
+   * multigrid setups. QUDA backed solvers load their gauge and clover fields into QUDA's
+   * one global state and free them when destroyed, so a solver outliving its measurement
+   * could run against another action's fields.
+   * The cache is a normal named object, erasing it frees all of it.
+   */
+  struct LalibeFermStateCache
+  {
+    std::string key;                   //action id, action xml and gauge id it was built for
+    Double gauge_check;                //checksum of the links, catches a gauge field replaced under the same id
+    Handle<FermionAction<LatticeFermion, multi1d<LatticeColorMatrix>, multi1d<LatticeColorMatrix>>> action;
+    Handle<FermState<LatticeFermion, multi1d<LatticeColorMatrix>, multi1d<LatticeColorMatrix>>> state;
+  };
+
+  //! Look up, or build and store, the cache for this action on this gauge field
+  LalibeFermStateCache& lalibeFermStateCache(const GroupXML_t& fermact, const std::string& gauge_id,
+					     const multi1d<LatticeColorMatrix>& u);
+
+  //! Erase every cache still in the named object map, needed before chroma finalizes
+  void lalibeClearFermStateCaches();
+}
+
+#endif
@@ -0,0 +1,47 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Hierarchical probing vectors filled site by site on each node
+ */
+
+#include "chromabase.h"
+#include "hadamard_probing.h"
+
+#include <bitset>
+#include <climits>
+
+namespace Chroma 
+{ 
+  namespace
+  {
+    //! Element (row, col) of the Sylvester-Hadamard matrix, same as Hada_element
+    inline int hada_sign(unsigned int row, unsigned int col)
+    {
+#if defined(__GNUC__)
+      return (__builtin_popcount(row & col) & 1) ? -1 : 1;
+#else
+      return (std::bitset<sizeof(unsigned int)*CHAR_BIT>(row & col).count() & 1) ? -1 : 1;
+#endif
+    }
+  }
+
+  void hadamardProbingVectors(const unsigned int* perm, const unsigned int* Hperm, int first_column,
+			      multi1d<LatticeInteger>& vectors)
+  {
+    START_CODE();
+
+    const int num_vecs = vectors.size();
+    multi1d<unsigned int> columns(num_vecs);
+    for(int k = 0; k < num_vecs; k++)
+      columns[k] = Hperm[first_column + k];
+
+    const int num_sites = Layout::sitesOnNode();
+    for(int site = 0; site < num_sites; site++)
+    {
+      const unsigned int row = perm[site];
+      for(int k = 0; k < num_vecs; k++)
+	vectors[k].elem(site).elem().elem().elem() = hada_sign(row, columns[k]);
+    }
+
+    END_CODE();
+  }
+}
@@ -0,0 +1,24 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Hierarchical probing vectors filled site by site on each node
+ */
+
+#ifndef __hadamard_probing_h__
+#define __hadamard_probing_h__
+
+#include "chromabase.h"
+
+namespace Chroma 
+{ 
+  //! Build hierarchically permuted Hadamard vectors on this node's sites
+  /*!
+   * vectors[k] gets Hadamard column Hperm[first_column + k], with its rows taken in the
+   * hierarchical order perm, indexed by the node-local linear site index as hierPerm gives it.
+   * Only local sites are touched: each site's row is looked up once and every vector is
+   * written in the same sweep, the sign being the parity of popcount(row & column).
+   */
+  void hadamardProbingVectors(const unsigned int* perm, const unsigned int* Hperm, int first_column,
+			      multi1d<LatticeInteger>& vectors);
+}
+
+#endif
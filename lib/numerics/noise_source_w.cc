@@ -0,0 +1,214 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Noise and probing vectors generated one at a time, on demand
+ */
+
+#include "chromabase.h"
+#include "noise_source_w.h"
+#include "hadamard_probing.h"
+#include "binaryRecursiveColoring.h"
+
+#include <cmath>
+#include <stdint.h>
+
+namespace Chroma 
+{ 
+  namespace
+  {
+    //! The draw every ZN vector is made from
+    void zn_draw(int ZN, LatticeComplex& vec)
+    {
+      LatticeReal rnd1, theta;
+      // twopi defined in chroma/lib/chromabase.h
+      Real twopiN = Chroma::twopi / ZN;
+      random(rnd1);
+      theta = twopiN * floor(ZN*rnd1);
+      vec = cmplx(cos(theta),sin(theta));
+    }
+
+    //! One Philox4x32-10 block, Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC11
+    void philox4x32(uint32_t ctr[4], const unsigned int key[2])
+    {
+      uint32_t k0 = key[0], k1 = key[1];
+      for (int round = 0; round < 10; round++)
+      {
+	const uint64_t p0 = uint64_t(0xD2511F53u) * ctr[0];
+	const uint64_t p1 = uint64_t(0xCD9E8D57u) * ctr[2];
+	const uint32_t c1 = ctr[1], c3 = ctr[3];
+	ctr[0] = uint32_t(p1 >> 32) ^ c1 ^ k0;
+	ctr[1] = uint32_t(p1);
+	ctr[2] = uint32_t(p0 >> 32) ^ c3 ^ k1;
+	ctr[3] = uint32_t(p0);
+	k0 += 0x9E3779B9u;
+	k1 += 0xBB67AE85u;
+      }
+    }
+
+    Seed seed_pow(const Seed& base, int n)
+    {
+      Seed result;
+      result = 1;
+      Seed power = base;
+      while (n > 0)
+      {
+	if (n & 1)
+	  result = result * power;
+	power = power * power;
+	n >>= 1;
+      }
+      return result;
+    }
+  }
+
+  ZNNoiseSource::ZNNoiseSource(const Seed& seed_, int ZN_) : seed(seed_), ZN(ZN_)
+  {
+    //Draw once from a unit state, what is left in the RNG is the multiplier of one draw.
+    Seed ran_seed;
+    QDP::RNG::savern(ran_seed);
+    Seed unit;
+    unit = 1;
+    QDP::RNG::setrn(unit);
+    LatticeReal rnd1;
+    random(rnd1);
+    QDP::RNG::savern(draw_mult);
+    QDP::RNG::setrn(ran_seed);
+  }
+
+  void ZNNoiseSource::operator()(int k, LatticeComplex& vec) const
+  {
+    START_CODE();
+
+    Seed ran_seed;
+    QDP::RNG::savern(ran_seed);
+    // Jump to the state right before draw k
+    QDP::RNG::setrn(seed * seed_pow(draw_mult, k - 1));
+    zn_draw(ZN, vec);
+    //restore the seed
+    QDP::RNG::setrn(ran_seed);
+
+    END_CODE();
+  }
+
+  CounterZNNoiseSource::CounterZNNoiseSource(const Seed& seed, int ZN_) : ZN(ZN_)
+  {
+    //The seed's xml is the same on every node and in every task, FNV-1a it down to the 64 bit key.
+    XMLBufferWriter seed_xml;
+    write(seed_xml, "Seed", seed);
+    const std::string seed_str = seed_xml.str();
+    uint64_t hash = 14695981039346656037ull;
+    for (std::string::size_type c = 0; c < seed_str.size(); c++)
+    {
+      hash ^= (unsigned char)(seed_str[c]);
+      hash *= 1099511628211ull;
+    }
+    key[0] = uint32_t(hash);
+    key[1] = uint32_t(hash >> 32);
+  }
+
+  void CounterZNNoiseSource::operator()(int k, LatticeComplex& vec) const
+  {
+    START_CODE();
+
+    //Chroma::twopi is a Real, the phases are taken in double and stored at the lattice precision
+    const double twopi = 6.283185307179586476925286;
+    multi1d<double> re(ZN), im(ZN);
+    for (int n = 0; n < ZN; n++)
+    {
+      re[n] = std::cos(twopi * n / ZN);
+      im[n] = std::sin(twopi * n / ZN);
+    }
+
+    const multi1d<int>& latt_size = Layout::lattSize();
+    const int node = Layout::nodeNumber();
+    const int num_sites = Layout::sitesOnNode();
+    for (int site = 0; site < num_sites; site++)
+    {
+      const multi1d<int> coord = Layout::siteCoords(node, site);
+      uint64_t global_site = 0;
+      for (int mu = Nd - 1; mu >= 0; mu--)
+	global_site = global_site * latt_size[mu] + coord[mu];
+
+      uint32_t ctr[4] = {uint32_t(global_site), uint32_t(global_site >> 32), uint32_t(k), 0};
+      philox4x32(ctr, key);
+      //floor(ZN*u) for u = ctr[0]/2^32, done in integers
+      const int n = int((uint64_t(ctr[0]) * ZN) >> 32);
+      vec.elem(site).elem().elem().real() = re[n];
+      vec.elem(site).elem().elem().imag() = im[n];
+    }
+
+    END_CODE();
+  }
+
+  Handle<LalibeNoiseSource> lalibeZNNoiseSource(const std::string& noise_engine, const Seed& seed, int ZN)
+  {
+    if (noise_engine == "qdp")
+      return Handle<LalibeNoiseSource>(new ZNNoiseSource(seed, ZN));
+    if (noise_engine == "counter")
+      return Handle<LalibeNoiseSource>(new CounterZNNoiseSource(seed, ZN));
+    QDPIO::cerr << __func__ << ": unknown noise_engine " << noise_engine << ", use qdp or counter" << std::endl;
+    QDP_abort(1);
+    return Handle<LalibeNoiseSource>();
+  }
+
+  HPNoiseSource::HPNoiseSource(const Seed& seed, int ZN, int max_vector)
+  {
+    START_CODE();
+
+    ZNNoiseSource(seed, ZN)(1, noise_vec);
+
+    //Here is where the HP stuff is created; adopted from Andrea's main function.
+    struct meshVars mesh;
+    unsigned int N;
+
+    mesh.d = Nd;
+    mesh.ptsPerDim = (unsigned int *)malloc(sizeof(unsigned int)*mesh.d);
+    N=1;
+    for (unsigned int i=0;i<mesh.d; i++){
+      //This logic is taken from Bit Twiddling Hacks by Sean Anderson, September 5, 2010
+      unsigned int v = Layout::lattSize()[i]; // compute the next highest power of 2 of 32-bit v
+      v--;
+      v |= v >> 1;
+      v |= v >> 2;
+      v |= v >> 4;
+      v |= v >> 8;
+      v |= v >> 16;
+      v++;
+      //Extend HP to beyond purely powers of two.
+      mesh.ptsPerDim[i] = v;
+      N *= mesh.ptsPerDim[i];
+    }
+
+    /* Set up the hierarchical data structs */
+    hierOrderSetUp(&mesh);
+
+    /* Find the row permutation once for each point in local mesh*/
+    perm.resize(Layout::sitesOnNode());
+    hierPerm(&mesh, perm.slice(), Layout::sitesOnNode());
+
+    /* Now with the perm obtained we do not need the mesh any more */
+    freeMeshVars(&mesh);
+
+    /* Create the column permutation of the Hadamard vectors, only as many columns as will be asked for */
+    /* CAUTION: N is the global size (total spatial dimension of the mesh) */
+    Hperm.resize(max_vector);
+    hadaColPerm(N, Hperm.slice(), max_vector);
+
+    END_CODE();
+  }
+
+  void HPNoiseSource::operator()(int k, LatticeComplex& vec) const
+  {
+    START_CODE();
+
+    if (k < 1 || k > Hperm.size())
+    {
+      QDPIO::cerr << __func__ << ": HP vector " << k << " is outside 1 to " << Hperm.size() << std::endl;
+      QDP_abort(1);
+    }
+    multi1d<LatticeInteger> column(1);
+    hadamardProbingVectors(perm.slice(), Hperm.slice(), k - 1, column);
+    vec = noise_vec*column[0];
+
+    END_CODE();
+  }
+}
@@ -0,0 +1,92 @@
+// -*- C++ -*-
+/*! \file
+ *  \brief Noise and probing vectors generated one at a time, on demand
+ */
+
+#ifndef __noise_source_w_h__
+#define __noise_source_w_h__
+
+#include "chromabase.h"
+#include "handle.h"
+
+#include <string>
+
+namespace Chroma 
+{ 
+  //! Produces vector k of a noise stream when asked, nothing is stored per vector
+  /*!
+   * Vectors count from 1, like starting_vector and ending_vector in the tasks, and any k
+   * can be asked for first, so memory does not grow with the number of vectors and
+   * starting at a high vector number costs the same as starting at 1.
+   */
+  class LalibeNoiseSource
+  {
+  public:
+    virtual ~LalibeNoiseSource() {}
+
+    //! Noise vector number k
+    virtual void operator()(int k, LatticeComplex& vec) const = 0;
+  };
+
+  //! The ZN vectors of ZN_PROPAGATOR and STOCHASTIC_FH_PROPAGATOR
+  /*!
+   * Vector k is the k-th lattice draw after setting the RNG to seed, exactly as the tasks used to
+   * replay them. The RNG state is a multiplicative congruential seed, so the state before draw k is
+   * seed times the per-draw multiplier to the k-1, computed by repeated squaring. The global RNG
+   * state is left as it was found.
+   */
+  class ZNNoiseSource : public LalibeNoiseSource
+  {
+  public:
+    ZNNoiseSource(const Seed& seed_, int ZN_);
+
+    void operator()(int k, LatticeComplex& vec) const;
+
+  private:
+    Seed seed;
+    int ZN;
+    Seed draw_mult;     //what one LatticeReal draw multiplies the RNG state by
+  };
+
+  //! Counter-based ZN vectors, keyed by (seed, vector number, global site)
+  /*!
+   * Every site of vector k is one Philox4x32-10 block of its lexicographic global site index and k,
+   * under a key hashed from the seed. Nothing is sequential, so any vector comes out in one sweep over
+   * the local sites and the noise does not depend on the node layout. These are NOT the vectors of
+   * ZNNoiseSource, the inversion and every task contracting with its noise have to use the same engine.
+   */
+  class CounterZNNoiseSource : public LalibeNoiseSource
+  {
+  public:
+    CounterZNNoiseSource(const Seed& seed, int ZN_);
+
+    void operator()(int k, LatticeComplex& vec) const;
+
+  private:
+    unsigned int key[2];
+    int ZN;
+  };
+
+  //! The ZN noise engine named by noise_engine, "qdp" (the QDP++ RNG, the default) or "counter"
+  Handle<LalibeNoiseSource> lalibeZNNoiseSource(const std::string& noise_engine, const Seed& seed, int ZN);
+
+  //! The hierarchical probing vectors of HP_PROPAGATOR and HP_FH_PROPAGATOR
+  /*!
+   * Vector k is Hadamard column k, in hierarchical order, times the first ZN vector of the seed.
+   * Only the local row permutation, the column permutation up to max_vector and that one ZN vector are kept.
+   */
+  class HPNoiseSource : public LalibeNoiseSource
+  {
+  public:
+    HPNoiseSource(const Seed& seed, int ZN, int max_vector);
+
+    void operator()(int k, LatticeComplex& vec) const;
+
+  private:
+    LatticeComplex noise_vec;
+    multi1d<unsigned int> perm;     //hierarchical row of each node-local site
+    multi1d<unsigned int> Hperm;    //Hadamard column of each vector
+  };
+}
+
+#endif
@@ -4,6 +4,8 @@
 
 #include "chroma.h"
 #include "../lib/measurements/lalibe_aggregate.h"
+#include "../lib/numerics/fermion_state_cache_w.h"
+#include "../lib/io/hdf5_writer_cache.h"
 
 using namespace Chroma;
 extern "C" {
@@ -237,6 +239,14 @@ int main(int argc, char *argv[])
 
     pop(xml_out); // pop("InlineObservables");
 
+    // Drop the fermion actions and states shared between measurements
+    lalibeClearFermStateCaches();
+
+#ifdef BUILD_HDF5
+    // Do the staged writes and close the HDF5 files the measurements left open
+    lalibeHDF5CloseAll();
+#endif
+
     // Reset the default gauge field
     InlineDefaultGaugeField::reset();
   }
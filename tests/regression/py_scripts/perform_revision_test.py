@@ -1,4 +1,5 @@
 import argparse
+import xml.etree.ElementTree as ET
 import compare_h5_files as diff_h5
 
 ''' When you add a new routine, which generates new data, you have to verify
@@ -28,6 +29,28 @@ diff_1_2 = dict()
 diff_1_2['lalibe_2pt_spectrum.h5'] = 'lalibe_2pt_spectrum_lime.h5'
 diff_1_2['lalibe_3ptfn.h5'] = 'lalibe_3ptfn_coherent_sink.h5'
 
+''' Consistency tests between two files produced in the same run, for options
+    that must not change the answer.  These have no known_results entry: the
+    reference is the default option, generated alongside the new one.
+'''
+diff_new = dict()
+diff_new['lalibe_2pt_ft_compact.h5'] = 'lalibe_2pt_ft_phases.h5'
+diff_new['lalibe_2pt_ft_fft.h5'] = 'lalibe_2pt_ft_phases.h5'
+diff_new['lalibe_2pt_precision_validate.h5'] = 'lalibe_2pt_precision_double.h5'
+diff_new['lalibe_2pt_precision_single.h5'] = 'lalibe_2pt_precision_double.h5'
+diff_new['lalibe_fh_batch_on.h5'] = 'lalibe_fh_batch_off.h5'
+diff_new['lalibe_zn_mrhs_on.h5'] = 'lalibe_zn_mrhs_off.h5'
+diff_new['lalibe_zn_counter_from3.h5'] = 'lalibe_zn_counter_from1.h5'
+
+''' single precision contractions are only expected to agree to float accuracy '''
+diff_new_rtol = dict()
+diff_new_rtol['lalibe_2pt_precision_single.h5'] = 1.e-5
+
+''' the XML output of these runs must report the single/double deviation '''
+validate_xml_files = [
+    'baryon_options_h5.out.xml',
+]
+
 PARSER = argparse.ArgumentParser(description='Perform revision test after files are generated')
 PARSER.add_argument('known_file_path', type=str, help='known_result_folder')
 PARSER.add_argument('new_file_path',   type=str, help='new_result_folder')
@@ -69,3 +92,28 @@ for f5 in diff_1_2:
         print('PASS:    ',f5, ' = ',diff_1_2[f5])
     else:
         print('FAIL:    ',f5, ' != ',diff_1_2[f5])
+
+for f5 in diff_new:
+    f_ref = args.new_file_path+'/'+diff_new[f5]
+    f_new = args.new_file_path+'/'+f5
+
+    revision_tests[f5] = diff_h5.assert_h5files_equal(
+        f_ref,
+        f_new,
+        atol=args.atol,
+        rtol=diff_new_rtol.get(f5, args.rtol),
+        verbose=args.verbose
+        )
+    if revision_tests[f5]:
+        print('PASS:    ',f5, ' = ',diff_new[f5])
+    else:
+        print('FAIL:    ',f5, ' != ',diff_new[f5])
+
+for fxml in validate_xml_files:
+    deviations = [float(d.text) for d in
+                  ET.parse(args.new_file_path+'/'+fxml).getroot().iter('max_rel_deviation')]
+    revision_tests[fxml] = len(deviations) > 0 and max(deviations) < diff_new_rtol['lalibe_2pt_precision_single.h5']
+    if revision_tests[fxml]:
+        print('PASS:    ',fxml, ' max_rel_deviation = ',max(deviations))
+    else:
+        print('FAIL:    ',fxml, ' max_rel_deviation = ',deviations)
@@ -19,10 +19,14 @@ ini_files=(
     fh-corrs_h5.ini.xml
     proton_seqprop_h5.ini.xml
     proton_formfac_h5.ini.xml
+    ft_modes_h5.ini.xml
+    baryon_options_h5.ini.xml
+    batched_solves_h5.ini.xml
+    counter_noise_h5.ini.xml
 )
 
 for ini in "${ini_files[@]}"; do
-    $mpirun -i $input_decks/$ini
+    $mpirun -i $input_decks/$ini -o ${ini%.ini.xml}.out.xml
 done
 
 $my_python $lalibe_tests/py_scripts/perform_revision_test.py $lalibe_tests/known_results `pwd`